@@ -26,13 +26,109 @@
 #define OPEN_DOOR_CMD 						0x11
 #define CHANGE_PASSWORD_CMD 				0x12
 
+/* The session commands carry the session token (high byte first) instead of the password */
+#define OPEN_DOOR_TOKEN_CMD 				0x13
+#define CHANGE_PASSWORD_TOKEN_CMD 			0x14
+
+/*
+ * The users commands of an admin session, they carry the session token, the user (enroll only)
+ * and the PIN of the user. The reply is the result then the new session token. This panel enrolls
+ * the users of its own door without the admin flag, USER_ID_DIGITS digits are typed for the user id.
+ */
+#define USER_ENROLL_TOKEN_CMD				0x60
+#define USER_REMOVE_TOKEN_CMD				0x61
+#define USER_UPDATED						0x62
+#define USER_NOT_UPDATED					0x63
+#define USER_ID_DIGITS						3
+#define USER_DOORS_MASK						(1 << HMI_DOOR_ID)
+#define USER_FLAGS							0
+
+/*
+ * The door status is asked at boot, the reply is the status frame then the remaining lock-out time
+ * of the door in seconds. A door with a saved password starts on the main screen, so a reset does
+ * not ask for a new password. The request is sent again if the Control ECU does not reply in time
+ * (it may still be booting), the replies of the repeated requests are dropped until the link is
+ * quiet for the same time.
+ */
+#define DOOR_STATUS_CMD						0x15
+#define DOOR_NO_PASSWORD_STATUS				0x44
+#define DOOR_PASSWORD_STATUS				0x45
+#define DOOR_STATUS_TIMEOUT_MS				100
+
+/* Every successful check is followed by the new session token (high byte first) */
 #define SUCCESSFUL_PASSWORD_CHECK   		0x20
 #define UNSUCCESSFUL_PASSWORD_CHECK   		0x19
 
+/* A wrong password that started the lock-out, it is followed by the lock-out time in seconds */
+#define LOCKED_OUT_PASSWORD_CHECK			0x17
+#define DEFAULT_LOCKOUT_TIME				60
+
+/* The session token is expired or wrong, the command is sent again with the password */
+#define SESSION_REJECTED					0x18
+
+/*
+ * The replies are waited for HMI_REPLY_TIMEOUT_MS, after a password entry the Enter frame is sent
+ * again HMI_REPLY_RETRIES times (the Control ECU ignores it once the entry is done) then the
+ * command is given up with NO_REPLY_CHECK.
+ */
+#define HMI_REPLY_TIMEOUT_MS				1000
+#define HMI_REPLY_RETRIES					2
+#define NO_REPLY_CHECK						0x00
+
+/* Incremental password frames, every typed digit is sent as ('0' + digit) then Enter ends the entry */
+#define PASSWORD_DIGIT_FRAME				0x30
+#define PASSWORD_ENTER_FRAME				0x0D
+
+/*
+ * Every frame on the link is preceded by the 9-bit address frame of its door, the panels share
+ * the bus and the UART address filter drops the data frames of the other doors in hardware.
+ * This panel controls door HMI_DOOR_ID.
+ */
+#define HMI_DOOR_ID							0
+#define DOOR_ADDRESS_FRAME(id)				(UART_ADDRESS_FLAG | (id))
+#define FRAME_IS_DOOR_ADDRESS(frame)		(((frame) & UART_ADDRESS_FLAG) != 0)
+#define FRAME_DOOR_ID(frame)				((uint8)(frame))
+
+/*
+ * The Control ECU is the bus master, it polls the panels in turn by their poll address frames.
+ * A panel sends one frame (its address frame then one data frame) after a poll of its door, so
+ * every sent frame waits for the next poll. The data frames received meanwhile are kept for the
+ * receive functions, up to HMI_PENDING_FRAMES frames.
+ */
+#define LINK_POLL_FLAG						0x80
+#define HMI_PENDING_FRAMES					8
+
+/* Door phase events sent by the Control ECU while the door is moving */
+#define DOOR_UNLOCKED_EVENT					0x40
+#define DOOR_LOCKING_EVENT					0x41
+#define DOOR_LOCKED_EVENT					0x42
+#define DOOR_JAMMED_EVENT					0x43
+
+/*
+ * Time to show the jammed door message, the Control ECU locks the door again and the next
+ * locking event comes within it. Without it the door is locked-out and the status is read.
+ */
+#define DOOR_JAMMED_MESSAGE_TIME_MS			2000
+
 #define DISPLAY_CREATE_PASSWORD_SCREEN   	0x21
 #define DISPLAY_MAIN_OPTIONS_SCREEN 		0x22
 #define DISPLAY_CONTROL_SCREEN 				0x23
 
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+/* States of the password input state machine, it consumes the buffered key stream */
+typedef enum
+{
+	PASSWORD_INPUT_DIGITS,
+
+	PASSWORD_INPUT_ENTER,
+
+	PASSWORD_INPUT_DONE
+
+}HMI_PasswordInputState;
+
 /****************************************************************************
  * 							   Global Variables								*
  ****************************************************************************/
@@ -41,7 +137,27 @@ uint8 password_again[PASSWORD_SIZE];
 
 uint8 g_flag = DISPLAY_CREATE_PASSWORD_SCREEN ;
 uint8 g_counter ;
-uint8 g_count_faults ;
+
+/* Seconds of the lock-out to show, the faults are counted by the Control ECU */
+uint8 g_lockout_time ;
+
+/*
+ * TRUE after the address frame of this door until the address frame of another door. The
+ * hardware filter is switched only when an address frame is read, the frames of another door
+ * may be in the receive buffer before it, so they are dropped by this flag.
+ */
+boolean g_addressed = FALSE ;
+
+/* TRUE after the poll of this door until the next poll or the answer */
+boolean g_polled = FALSE ;
+
+/* Data frames of this door read from the UART and not returned yet, in the receiving order */
+uint8 g_pendingFrames[HMI_PENDING_FRAMES] ;
+uint8 g_pendingCount = 0 ;
+
+/* Session token issued by the Control ECU with the last successful check */
+uint16 g_session_token ;
+boolean g_session_valid = FALSE ;
 
 /****************************************************************************
  * 							Functions Prototypes						    *
@@ -49,11 +165,22 @@ uint8 g_count_faults ;
 void HMI_ECU_createPassword(uint8 *password_buffer_1,uint8 *password_buffer_2,uint8 size);
 void HMI_ECU_enterPassword(uint8 *password_buffer, uint8 size);
 void HMI_ECU_re_enterPassword(uint8 *password_buffer, uint8 size);
-void HMI_ECU_sendPassword(uint8 *password_buffer, uint8 size);
+void HMI_ECU_readPassword(uint8 *password_buffer, uint8 size, boolean send_frames);
 void HMI_ECU_mainOptionsScreen(uint8 *password_buffer, uint8 size);
+void HMI_ECU_usersScreen(uint8 *password_buffer, uint8 size);
+uint16 HMI_ECU_readUserId(void);
+uint8 HMI_ECU_sendUserCommand(uint8 command,uint16 user_id,const uint8 *password_buffer,uint8 size);
 void HMI_ECU_displayControlScreenConfig(void);
 void HMI_ECU_displayErrorMessageConfig(void);
 void HMI_ECU_callBackFunction(void);
+void HMI_ECU_requestStatus(void);
+void HMI_ECU_sendFrame(uint8 frame);
+void HMI_ECU_readLink(void);
+boolean HMI_ECU_pollFrame(uint8 *frame);
+uint8 HMI_ECU_receiveFrame(void);
+boolean HMI_ECU_receiveFrameTimeout(uint8 *frame,uint16 timeout_ms);
+uint8 HMI_ECU_sendCommand(uint8 command,uint8 token_command,uint8 *password_buffer,uint8 size);
+uint8 HMI_ECU_receiveCheckStatus(boolean resend_enter);
 
 /****************************************************************************
  * 							   Main Function								*
@@ -64,22 +191,40 @@ int main()
 
 	LCD_init();
 
+	KEYPAD_init();
+
+	/* Only the presses are consumed, so every queued event is a typed-ahead key */
+	KEYPAD_setEventFilter(KEYPAD_EVENT_MASK(KEYPAD_EVENT_PRESS));
+
 	UART_ConfigType UART_ConfigStruct ;
 	UART_ConfigStruct.baud_rate = 19200 ;
-	UART_ConfigStruct.bit_data = Eight_Bit_Data ;
+	UART_ConfigStruct.bit_data = Nine_Bit_Data ;
 	UART_ConfigStruct.parity = Disable_Parity ;
 	UART_ConfigStruct.stop_bit = One_Bit_Stop ;
 	UART_init(&UART_ConfigStruct);
+	UART_setAddressFilter(TRUE);
+
+	HMI_ECU_requestStatus();
 
 	while(1)
 	{
+		/* A lock-out is shown first, it may be restored by the status after a reset */
+		if(g_lockout_time != 0)
+		{
+			HMI_ECU_displayErrorMessageConfig();
+		}
 		if(g_flag == DISPLAY_CREATE_PASSWORD_SCREEN)
 		{
 			HMI_ECU_createPassword(password, password_again, PASSWORD_SIZE);
-			if(UART_receiveByte() == SUCCESSFUL_PASSWORD_CHECK)
+			if(HMI_ECU_receiveCheckStatus(TRUE) == SUCCESSFUL_PASSWORD_CHECK)
 			{
 				g_flag = DISPLAY_MAIN_OPTIONS_SCREEN ;
 			}
+			else
+			{
+				/* A change is refused once its session ends, the saved password is kept then */
+				HMI_ECU_requestStatus();
+			}
 		}
 		if(g_flag == DISPLAY_MAIN_OPTIONS_SCREEN)
 		{
@@ -89,10 +234,6 @@ int main()
 		{
 			HMI_ECU_displayControlScreenConfig();
 		}
-		if(g_count_faults == 3)
-		{
-			HMI_ECU_displayErrorMessageConfig();
-		}
 	}
 
 	return 0 ;
@@ -103,7 +244,7 @@ int main()
  ****************************************************************************/
 void HMI_ECU_createPassword(uint8 *password_buffer_1,uint8 *password_buffer_2,uint8 size)
 {
-	UART_sendByte(CREATE_PASSWORD_CMD);
+	HMI_ECU_sendFrame(CREATE_PASSWORD_CMD);
 	HMI_ECU_enterPassword(password_buffer_1,size);
 	HMI_ECU_re_enterPassword(password_buffer_2,size);
 }
@@ -113,16 +254,7 @@ void HMI_ECU_enterPassword(uint8 *password_buffer, uint8 size)
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 0, "plz enter pass: ");
 	LCD_moveCursor(1, 0);
-	uint8 index ;
-	for(index = 0 ; index < size ; index++)
-	{
-		password_buffer[index] = KEYPAD_getPressedKey();
-		LCD_displayCharacter('*');
-		_delay_ms(250);
-	}
-	while(!(KEYPAD_getPressedKey() == ENTER_VALUE));
-	_delay_ms(250);
-	HMI_ECU_sendPassword(password_buffer, size);
+	HMI_ECU_readPassword(password_buffer, size, TRUE);
 }
 
 void HMI_ECU_re_enterPassword(uint8 *password_buffer, uint8 size)
@@ -130,24 +262,58 @@ void HMI_ECU_re_enterPassword(uint8 *password_buffer, uint8 size)
 	LCD_clearScreen();
 	LCD_displayStringRowColumn(0, 0, "plz re-enter the");
 	LCD_displayStringRowColumn(1, 0, "same pass: ");
-	uint8 index ;
-	for(index = 0 ; index < size ; index++)
-	{
-		password_buffer[index] = KEYPAD_getPressedKey();
-		LCD_displayCharacter('*');
-		_delay_ms(250);
-	}
-	while(!(KEYPAD_getPressedKey() == ENTER_VALUE));
-	_delay_ms(250);
-	HMI_ECU_sendPassword(password_buffer, size);
+	HMI_ECU_readPassword(password_buffer, size, TRUE);
 }
 
-void HMI_ECU_sendPassword(uint8 *password_buffer,uint8 size)
+/*
+ * The digits of a password are sent while they are typed if send_frames is TRUE,
+ * a user PIN is only stored and it is sent with its users command.
+ */
+void HMI_ECU_readPassword(uint8 *password_buffer, uint8 size, boolean send_frames)
 {
-	uint8 index ;
-	for(index = 0 ; index < size ; index++)
+	HMI_PasswordInputState state = PASSWORD_INPUT_DIGITS ;
+	uint8 index = 0 ;
+	uint8 key_value ;
+
+	/*
+	 * The keys come from the keypad FIFO, so the keys typed during the LCD redraws or
+	 * while waiting for the Control ECU reply are consumed here in order.
+	 * Every digit is forwarded at once, the Control ECU compares it while the next one is typed.
+	 */
+	while(state != PASSWORD_INPUT_DONE)
 	{
-		UART_sendByte(password_buffer[index]);
+		key_value = KEYPAD_getPressedKey();
+		switch(state)
+		{
+		case PASSWORD_INPUT_DIGITS :
+			if(key_value <= 9)
+			{
+				password_buffer[index] = key_value ;
+				index++ ;
+				if(send_frames)
+				{
+					HMI_ECU_sendFrame(PASSWORD_DIGIT_FRAME + key_value);
+				}
+				LCD_displayCharacter('*');
+				if(index == size)
+				{
+					state = PASSWORD_INPUT_ENTER ;
+				}
+			}
+			break;
+		case PASSWORD_INPUT_ENTER :
+			if(key_value == ENTER_VALUE)
+			{
+				if(send_frames)
+				{
+					HMI_ECU_sendFrame(PASSWORD_ENTER_FRAME);
+				}
+				state = PASSWORD_INPUT_DONE ;
+			}
+			break;
+		case PASSWORD_INPUT_DONE :
+			break;
+		}
 	}
 }
 
@@ -155,74 +321,189 @@ void HMI_ECU_mainOptionsScreen(uint8 *password_buffer, uint8 size)
 {
 	uint8 key_value;
 	LCD_clearScreen();
-	LCD_displayStringRowColumn(0, 0, "+ : Open Door");
+	LCD_displayStringRowColumn(0, 0, "+:Open  *:Users");
 	LCD_displayStringRowColumn(1, 0, "- : Change Pass");
 	key_value = KEYPAD_getPressedKey();
-	_delay_ms(250);
-	while(!((key_value == '+') || (key_value == '-')))
+	while(!((key_value == '+') || (key_value == '-') || (key_value == '*')))
 	{
 		key_value = KEYPAD_getPressedKey();
-		_delay_ms(250);
 	}
 	switch(key_value)
 	{
 	case '+' :
-		UART_sendByte(OPEN_DOOR_CMD);
-		HMI_ECU_enterPassword(password_buffer, size);
-		if(UART_receiveByte() == SUCCESSFUL_PASSWORD_CHECK)
+		if(HMI_ECU_sendCommand(OPEN_DOOR_CMD, OPEN_DOOR_TOKEN_CMD, password_buffer, size) == SUCCESSFUL_PASSWORD_CHECK)
 		{
-			g_count_faults = 0 ;
 			g_flag = DISPLAY_CONTROL_SCREEN ;
 		}
-		else
-		{
-			g_count_faults += 1 ;
-		}
 		break;
 	case '-' :
-		UART_sendByte(CHANGE_PASSWORD_CMD);
-		HMI_ECU_enterPassword(password_buffer, size);
-		if(UART_receiveByte() == SUCCESSFUL_PASSWORD_CHECK)
+		if(HMI_ECU_sendCommand(CHANGE_PASSWORD_CMD, CHANGE_PASSWORD_TOKEN_CMD, password_buffer, size) == SUCCESSFUL_PASSWORD_CHECK)
 		{
-			g_count_faults = 0 ;
 			g_flag = DISPLAY_CREATE_PASSWORD_SCREEN ;
 		}
-		else
+		break;
+	case '*' :
+		HMI_ECU_usersScreen(password_buffer, size);
+		break;
+	}
+}
+
+/*
+ * The users are added and removed in the session of an admin, it is opened by the door password
+ * or an admin PIN. The result is shown until a key is pressed.
+ */
+void HMI_ECU_usersScreen(uint8 *password_buffer, uint8 size)
+{
+	uint8 key_value ;
+	uint8 result ;
+	uint16 user_id = 0 ;
+
+	LCD_clearScreen();
+	if(!g_session_valid)
+	{
+		LCD_displayStringRowColumn(0, 0, "plz open door");
+		LCD_displayStringRowColumn(1, 0, "first");
+		KEYPAD_getPressedKey();
+		return ;
+	}
+
+	LCD_displayStringRowColumn(0, 0, "+ : Add User");
+	LCD_displayStringRowColumn(1, 0, "- : Remove User");
+	key_value = KEYPAD_getPressedKey();
+	while(!((key_value == '+') || (key_value == '-')))
+	{
+		key_value = KEYPAD_getPressedKey();
+	}
+
+	if(key_value == '+')
+	{
+		user_id = HMI_ECU_readUserId();
+	}
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "plz enter pin: ");
+	LCD_moveCursor(1, 0);
+	HMI_ECU_readPassword(password_buffer, size, FALSE);
+
+	result = HMI_ECU_sendUserCommand(((key_value == '+') ? USER_ENROLL_TOKEN_CMD : USER_REMOVE_TOKEN_CMD), user_id, password_buffer, size);
+
+	LCD_clearScreen();
+	if(result == USER_UPDATED)
+	{
+		LCD_displayStringRowColumn(0, 0, "User Updated");
+	}
+	else if(result == USER_NOT_UPDATED)
+	{
+		LCD_displayStringRowColumn(0, 0, "User Not Updated");
+	}
+	else
+	{
+		LCD_displayStringRowColumn(0, 0, "Session Closed");
+	}
+	LCD_displayStringRowColumn(1, 0, "press any key");
+	KEYPAD_getPressedKey();
+}
+
+/*
+ * The user id is typed as USER_ID_DIGITS digits then Enter, its digits are shown.
+ */
+uint16 HMI_ECU_readUserId(void)
+{
+	uint16 user_id = 0 ;
+	uint8 index = 0 ;
+	uint8 key_value ;
+
+	LCD_clearScreen();
+	LCD_displayStringRowColumn(0, 0, "plz enter id: ");
+	LCD_moveCursor(1, 0);
+	do
+	{
+		key_value = KEYPAD_getPressedKey();
+		if((key_value <= 9) && (index < USER_ID_DIGITS))
 		{
-			g_count_faults += 1 ;
+			user_id = (user_id * 10) + key_value ;
+			index++ ;
+			LCD_displayCharacter('0' + key_value);
 		}
-		break;
+	}while(!((key_value == ENTER_VALUE) && (index == USER_ID_DIGITS)));
+
+	return user_id ;
+}
+
+/*
+ * Send the users command with the session token, the reply is the result then the new token.
+ * A rejected token or a missing reply closes the session, it returns SESSION_REJECTED then.
+ */
+uint8 HMI_ECU_sendUserCommand(uint8 command,uint16 user_id,const uint8 *password_buffer,uint8 size)
+{
+	uint8 result ;
+	uint8 token_high ;
+	uint8 token_low ;
+	uint8 index ;
+
+	HMI_ECU_sendFrame(command);
+	HMI_ECU_sendFrame((uint8)(g_session_token >> 8));
+	HMI_ECU_sendFrame((uint8)g_session_token);
+	if(command == USER_ENROLL_TOKEN_CMD)
+	{
+		HMI_ECU_sendFrame((uint8)(user_id >> 8));
+		HMI_ECU_sendFrame((uint8)user_id);
+		HMI_ECU_sendFrame(USER_DOORS_MASK);
+		HMI_ECU_sendFrame(USER_FLAGS);
+	}
+	for(index = 0 ; index < size ; index++)
+	{
+		HMI_ECU_sendFrame(PASSWORD_DIGIT_FRAME + password_buffer[index]);
+	}
+	HMI_ECU_sendFrame(PASSWORD_ENTER_FRAME);
+
+	g_session_valid = FALSE ;
+	if(!HMI_ECU_receiveFrameTimeout(&result, HMI_REPLY_TIMEOUT_MS) ||
+	   ((result != USER_UPDATED) && (result != USER_NOT_UPDATED)))
+	{
+		return SESSION_REJECTED ;
 	}
+
+	if(HMI_ECU_receiveFrameTimeout(&token_high, HMI_REPLY_TIMEOUT_MS) &&
+	   HMI_ECU_receiveFrameTimeout(&token_low, HMI_REPLY_TIMEOUT_MS))
+	{
+		g_session_token = ((uint16)token_high << 8) | token_low ;
+		g_session_valid = TRUE ;
+	}
+
+	return result ;
 }
 
 void HMI_ECU_displayControlScreenConfig(void)
 {
-	g_counter = 0 ;
-	Timer1_setCallBack(HMI_ECU_callBackFunction);
-	Timer1_ConfigType Timer1_ConfigStruct;
-	Timer1_ConfigStruct.mode = Timer1_Compare_Mode ;
-	Timer1_ConfigStruct.prescaler = F_CPU_1024 ;
-	Timer1_ConfigStruct.initial_value = 0 ;
-	Timer1_ConfigStruct.compare_value = 7812 ;
-	Timer1_init(&Timer1_ConfigStruct);
+	uint8 door_event ;
+
 	LCD_clearScreen();
-	while(!(g_counter == 33))
+	LCD_displayStringRowColumn(0, 0, "Door's Unlocking");
+
+	/* The Control ECU reports every phase once the door reaches its limit */
+	do
 	{
-		if(g_counter < 15)
+		door_event = HMI_ECU_receiveFrame();
+		if(door_event == DOOR_JAMMED_EVENT)
 		{
-			LCD_displayStringRowColumn(0, 0, "Door's Unlocking");
+			/* The Control ECU stopped the motor on a stall, the message is shown until its next event */
+			LCD_displayStringRowColumn(0, 0, "Door is Jammed !");
+			if(!HMI_ECU_receiveFrameTimeout(&door_event, DOOR_JAMMED_MESSAGE_TIME_MS))
+			{
+				HMI_ECU_requestStatus();
+				return ;
+			}
 		}
-		if(g_counter == 15)
+		if(door_event == DOOR_UNLOCKED_EVENT)
 		{
 			LCD_displayStringRowColumn(0, 0, "Door is Unlocked");
 		}
-		if(g_counter == 18)
+		else if(door_event == DOOR_LOCKING_EVENT)
 		{
 			LCD_displayStringRowColumn(0, 0, "Door is Locking ");
 		}
-	}
-	Timer1_deInit();
-	g_counter = 0 ;
+	}while(door_event != DOOR_LOCKED_EVENT);
+
 	g_flag = DISPLAY_MAIN_OPTIONS_SCREEN ;
 }
 
@@ -236,14 +517,16 @@ void HMI_ECU_displayErrorMessageConfig(void)
 	Timer1_ConfigStruct.compare_value = 7812 ;
 	Timer1_init(&Timer1_ConfigStruct);
 	LCD_clearScreen();
-	while(!(g_counter == 60))
+	while(g_counter < g_lockout_time)
 	{
 		LCD_displayStringRowColumn(0, 0, "error !!");
 	}
 	Timer1_deInit();
-	g_count_faults = 0 ;
+
+	/* The keys typed during the lock-out are not accepted as type-ahead */
+	KEYPAD_flushEvents();
+	g_lockout_time = 0 ;
 	g_counter = 0 ;
-	g_flag = DISPLAY_MAIN_OPTIONS_SCREEN ;
 }
 
 void HMI_ECU_callBackFunction(void)
@@ -251,3 +534,192 @@ void HMI_ECU_callBackFunction(void)
 	g_counter += 1 ;
 	TCNT1 = 0 ;
 }
+
+/*
+ * Ask the Control ECU for the door status and start on its screen, the frames of a door
+ * sequence interrupted by the reset are dropped.
+ */
+void HMI_ECU_requestStatus(void)
+{
+	uint8 status ;
+
+	while(1)
+	{
+		HMI_ECU_sendFrame(DOOR_STATUS_CMD);
+		while(HMI_ECU_receiveFrameTimeout(&status, DOOR_STATUS_TIMEOUT_MS))
+		{
+			if((status == DOOR_PASSWORD_STATUS) || (status == DOOR_NO_PASSWORD_STATUS))
+			{
+				if(!HMI_ECU_receiveFrameTimeout(&g_lockout_time, DOOR_STATUS_TIMEOUT_MS))
+				{
+					g_lockout_time = 0 ;
+				}
+				g_flag = (status == DOOR_PASSWORD_STATUS) ? DISPLAY_MAIN_OPTIONS_SCREEN : DISPLAY_CREATE_PASSWORD_SCREEN ;
+
+				/* The late replies of the repeated requests must not be read as the next replies */
+				while(HMI_ECU_receiveFrameTimeout(&status, DOOR_STATUS_TIMEOUT_MS));
+				return ;
+			}
+		}
+	}
+}
+
+/*
+ * Send the frame after the next poll of this door, a poll read before the call may be old and the
+ * Control ECU may be polling another node now.
+ */
+void HMI_ECU_sendFrame(uint8 frame)
+{
+	HMI_ECU_readLink();
+	g_polled = FALSE ;
+	while(!g_polled)
+	{
+		HMI_ECU_readLink();
+	}
+	g_polled = FALSE ;
+
+	UART_sendNineBit(DOOR_ADDRESS_FRAME(HMI_DOOR_ID));
+	UART_sendNineBit(frame);
+}
+
+/*
+ * Read the waiting frames without blocking. Every address frame updates the addressed flag and
+ * the hardware filter, the address of this door disables the filter and the address of another
+ * door or a poll enables it again. The data frames of this door are kept in the pending frames.
+ */
+void HMI_ECU_readLink(void)
+{
+	uint16 received ;
+
+	while(UART_receiveNineBitNonBlocking(&received))
+	{
+		if(FRAME_IS_DOOR_ADDRESS(received))
+		{
+			g_polled = (FRAME_DOOR_ID(received) == (LINK_POLL_FLAG | HMI_DOOR_ID)) ;
+			g_addressed = (FRAME_DOOR_ID(received) == HMI_DOOR_ID) ;
+			UART_setAddressFilter(!g_addressed);
+		}
+		else if(g_addressed && (g_pendingCount < HMI_PENDING_FRAMES))
+		{
+			g_pendingFrames[g_pendingCount] = (uint8)received ;
+			g_pendingCount++ ;
+		}
+	}
+}
+
+/*
+ * Return the oldest data frame of this door without blocking.
+ */
+boolean HMI_ECU_pollFrame(uint8 *frame)
+{
+	uint8 index ;
+
+	HMI_ECU_readLink();
+	if(g_pendingCount == 0)
+	{
+		return FALSE ;
+	}
+
+	*frame = g_pendingFrames[0] ;
+	g_pendingCount-- ;
+	for(index = 0 ; index < g_pendingCount ; index++)
+	{
+		g_pendingFrames[index] = g_pendingFrames[index + 1] ;
+	}
+
+	return TRUE ;
+}
+
+/*
+ * Wait for the next frame addressed to this door.
+ */
+uint8 HMI_ECU_receiveFrame(void)
+{
+	uint8 frame ;
+
+	while(!HMI_ECU_pollFrame(&frame));
+
+	return frame ;
+}
+
+/*
+ * Wait up to timeout_ms for the next frame addressed to this door, it returns FALSE on the timeout.
+ */
+boolean HMI_ECU_receiveFrameTimeout(uint8 *frame,uint16 timeout_ms)
+{
+	while(timeout_ms != 0)
+	{
+		if(HMI_ECU_pollFrame(frame))
+		{
+			return TRUE ;
+		}
+		_delay_ms(1);
+		timeout_ms-- ;
+	}
+
+	return FALSE ;
+}
+
+/*
+ * Send the command with the session token while the session is open, the password is asked
+ * only when there is no session or the Control ECU rejects the token.
+ */
+uint8 HMI_ECU_sendCommand(uint8 command,uint8 token_command,uint8 *password_buffer,uint8 size)
+{
+	uint8 check_status ;
+
+	if(g_session_valid)
+	{
+		HMI_ECU_sendFrame(token_command);
+		HMI_ECU_sendFrame((uint8)(g_session_token >> 8));
+		HMI_ECU_sendFrame((uint8)g_session_token);
+		check_status = HMI_ECU_receiveCheckStatus(FALSE);
+		if((check_status != SESSION_REJECTED) && (check_status != NO_REPLY_CHECK))
+		{
+			return check_status ;
+		}
+	}
+
+	HMI_ECU_sendFrame(command);
+	HMI_ECU_enterPassword(password_buffer, size);
+	return HMI_ECU_receiveCheckStatus(TRUE);
+}
+
+/*
+ * Receive the check status and the new session token after a successful check, any other status
+ * or a missing token closes the session. A lost Enter frame is sent again if resend_enter is TRUE.
+ */
+uint8 HMI_ECU_receiveCheckStatus(boolean resend_enter)
+{
+	uint8 retries = resend_enter ? HMI_REPLY_RETRIES : 0 ;
+	uint8 check_status ;
+	uint8 token_high ;
+	uint8 token_low ;
+
+	g_session_valid = FALSE ;
+
+	while(!HMI_ECU_receiveFrameTimeout(&check_status, HMI_REPLY_TIMEOUT_MS))
+	{
+		if(retries == 0)
+		{
+			return NO_REPLY_CHECK ;
+		}
+		retries-- ;
+		HMI_ECU_sendFrame(PASSWORD_ENTER_FRAME);
+	}
+
+	if((check_status == SUCCESSFUL_PASSWORD_CHECK) &&
+	   HMI_ECU_receiveFrameTimeout(&token_high, HMI_REPLY_TIMEOUT_MS) &&
+	   HMI_ECU_receiveFrameTimeout(&token_low, HMI_REPLY_TIMEOUT_MS))
+	{
+		g_session_token = ((uint16)token_high << 8) | token_low ;
+		g_session_valid = TRUE ;
+	}
+	else if((check_status == LOCKED_OUT_PASSWORD_CHECK) &&
+	        !HMI_ECU_receiveFrameTimeout(&g_lockout_time, HMI_REPLY_TIMEOUT_MS))
+	{
+		g_lockout_time = DEFAULT_LOCKOUT_TIME ;
+	}
+
+	return check_status ;
+}
@@ -10,24 +10,108 @@
 /****************************************************************************
  * 								  Includes								    *
  ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
 #include "keypad.h"
+#include "timer0.h"
+#include "external_interrupt.h"
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/*
+ * Keypad map table in flash, indexed by [row][col] of the keypad configuration.
+ * It maps every switch to its functional value in the proteus keypad.
+ */
+static const uint8 g_keypadMap[KEYPAD_NUM_OF_ROWS][KEYPAD_NUM_OF_COLS] PROGMEM =
+{
+#if((KEYPAD_NUM_OF_ROWS == 4) && (KEYPAD_NUM_OF_COLS == 3))
+	{ 1  , 2 , 3   },
+	{ 4  , 5 , 6   },
+	{ 7  , 8 , 9   },
+	{ '*', 0 , '#' }
+#elif((KEYPAD_NUM_OF_ROWS == 4) && (KEYPAD_NUM_OF_COLS == 4))
+	{ 7  , 8 , 9  , '%' },
+	{ 4  , 5 , 6  , '*' },
+	{ 1  , 2 , 3  , '-' },
+	{ 13 , 0 , '=', '+' }	/* 13 is the ASCII of Enter */
+#else
+#error "Keypad map is defined for 4x3 and 4x4 keypads only"
+#endif
+};
+
+/* The row which is currently driven low by the scanner */
+static volatile uint8 g_scanRow = 0 ;
+
+/* Debounce integrator for every key, it counts up while pressed and down while released */
+static uint8 g_debounceCounter[KEYPAD_NUM_OF_KEYS];
+
+/* Debounced state for every key (bit per key) */
+static uint16 g_keysState = 0 ;
+
+/* The last pressed key is the only one which can repeat */
+static uint8 g_repeatKeyIndex = KEYPAD_NUM_OF_KEYS ;
+static uint8 g_repeatCounter = 0 ;
+
+/*
+ * Key events FIFO, written by the scanner ISR and read by the application. The head and the tail
+ * are free running counts masked on every access, so a full FIFO (head - tail == size) is told
+ * apart from an empty one and all the slots are used.
+ */
+static KEYPAD_EventType g_eventQueue[KEYPAD_EVENT_QUEUE_SIZE];
+static volatile uint8 g_eventHead = 0 ;
+static volatile uint8 g_eventTail = 0 ;
+
+/* Event kinds which are queued in the FIFO */
+static volatile uint8 g_eventFilter = KEYPAD_ALL_EVENTS ;
+
+/* Number of consecutive full scans without any key activity */
+static uint8 g_idleScans = 0 ;
+
+/* Bit per row, set while any key of the row is pressed or still settling */
+static uint8 g_rowsBusy = 0 ;
+
+/* Wake-up latency measurement, counts the ticks from the wake-up interrupt to the first press */
+static boolean g_wakeupPending = FALSE ;
+static uint16 g_wakeupTicks = 0 ;
+
+static KEYPAD_StatsType g_stats ;
 
 /****************************************************************************
  * 						 Static Functions Prototypes						*
  ****************************************************************************/
 
-#if(KEYPAD_NUM_OF_COLS == 3)
 /*
- * Function responsible for mapping the switch number in the keypad to
- * its corresponding functional number in the proteus for 4x3 keypad
+ * Function responsible for pushing a key event into the FIFO,
+ * the event is dropped if the FIFO is full.
+ */
+static void KEYPAD_pushEvent(uint8 key_index, KEYPAD_EventKind kind);
+
+/*
+ * Function responsible for updating the debounce integrator of one key
+ * with its new raw sample and reporting the press/release events.
+ */
+static void KEYPAD_debounceKey(uint8 key_index, boolean raw_pressed);
+
+/*
+ * Function responsible for starting the Timer0 scan tick from the first row.
+ */
+static void KEYPAD_startScanning(void);
+
+#if(KEYPAD_IDLE_MODE_ENABLE == TRUE)
+/*
+ * Function responsible for stopping the scanner, driving all rows low
+ * and arming the wake-up interrupt.
  */
-static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number);
-#elif(KEYPAD_NUM_OF_COLS == 4)
+static void KEYPAD_enterIdle(void);
+
 /*
- * Function responsible for mapping the switch number in the keypad to
- * its corresponding functional number in the proteus for 4x4 keypad
+ * Wake-up interrupt Call Back function, restarts the scanner.
  */
-static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
+static void KEYPAD_wakeUp(void);
 #endif
 
 /****************************************************************************
@@ -36,134 +120,385 @@ static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
 
 /* Inputs: void.
  *
- * Return Value: Keypad pressed button value.
+ * Return Value: void.
  *
  * Description:
- *	Get the Keypad pressed button.
+ *	Setup the rows/columns pins once and start the Timer0 tick that scans one
+ *	keypad row every KEYPAD_SCAN_TICK_MS in the background.
  */
-uint8 KEYPAD_getPressedKey(void)
+void KEYPAD_init(void)
 {
-	uint8 row = 0 ;
-	uint8 col = 0 ;
-
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,  KEYPAD_FIRST_ROW_PIN_ID   , PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, (KEYPAD_FIRST_ROW_PIN_ID+1), PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, (KEYPAD_FIRST_ROW_PIN_ID+2), PIN_INPUT);
-	GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, (KEYPAD_FIRST_ROW_PIN_ID+3), PIN_INPUT);
-
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID,  KEYPAD_FIRST_COL_PIN_ID   , PIN_INPUT);
-	GPIO_writePin(KEYPAD_COL_PORT_ID, KEYPAD_FIRST_COL_PIN_ID, LOGIC_HIGH);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+1), PIN_INPUT);
-	GPIO_writePin(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+1), LOGIC_HIGH);
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+2), PIN_INPUT);
-	GPIO_writePin(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+2), LOGIC_HIGH);
-#if(KEYPAD_NUM_OF_COLS == 4)
-	GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+3), PIN_INPUT);
-	GPIO_writePin(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+3), LOGIC_HIGH);
+	uint8 index ;
+
+	/* All rows are inputs (Hi-Z) except the scanned one */
+	for(index = 0 ; index < KEYPAD_NUM_OF_ROWS ; index++)
+	{
+		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, (KEYPAD_FIRST_ROW_PIN_ID+index), PIN_INPUT);
+		GPIO_writePin(KEYPAD_ROW_PORT_ID, (KEYPAD_FIRST_ROW_PIN_ID+index), LOGIC_LOW);
+	}
+
+	/* Columns are inputs with the internal pull-up resistors enabled */
+	for(index = 0 ; index < KEYPAD_NUM_OF_COLS ; index++)
+	{
+		GPIO_setupPinDirection(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+index), PIN_INPUT);
+		GPIO_writePin(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+index), LOGIC_HIGH);
+	}
+
+	/* The ECU sleeps in idle mode while waiting for keys, the timers and UART still wake it up */
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+#if(KEYPAD_IDLE_MODE_ENABLE == TRUE)
+	ExtInt_setCallBack(KEYPAD_WAKEUP_INT_ID, KEYPAD_wakeUp);
 #endif
 
-	while(1)
+	Timer0_setCallBack(KEYPAD_scanTick);
+	KEYPAD_startScanning();
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Scan one row of the keypad, debounce its keys and push the press/release/repeat/chord
+ *	events into the key event FIFO. It is called from the Timer0 interrupt.
+ */
+void KEYPAD_scanTick(void)
+{
+	uint8 row = g_scanRow ;
+	uint8 row_bit = (1<<row) ;
+
+	/* Sample all the columns of the row which was driven low on the previous tick by one read */
+	uint8 cols = ((uint8)(~KEYPAD_COL_PIN_REG) >> KEYPAD_FIRST_COL_PIN_ID) & KEYPAD_COLS_MASK ;
+
+	/* Fast path: nothing pressed on this row and all its keys are settled */
+	if(cols || (g_rowsBusy & row_bit))
 	{
-		/* loop for rows */
-		for(row = 0 ; row < KEYPAD_NUM_OF_ROWS ; row++)
+		uint8 key_index = (row*KEYPAD_NUM_OF_COLS) ;
+		uint8 busy = 0 ;
+		uint8 col ;
+
+		for(col = 0 ; col < KEYPAD_NUM_OF_COLS ; col++)
+		{
+			KEYPAD_debounceKey(key_index, (cols & 1));
+			busy |= g_debounceCounter[key_index] ;
+			cols >>= 1 ;
+			key_index++ ;
+		}
+
+		if(busy)
+		{
+			g_rowsBusy |= row_bit ;
+		}
+		else
 		{
-			/*
-			 * Each time setup the direction for all keypad port as input pins,
-			 * except this row will be output pin
-			 */
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, (KEYPAD_FIRST_ROW_PIN_ID+row), PIN_OUTPUT);
+			g_rowsBusy &= ~row_bit ;
+		}
+	}
 
-			/* Clear the row output pin */
-			GPIO_writePin(KEYPAD_ROW_PORT_ID, (KEYPAD_FIRST_ROW_PIN_ID+row), KEYPAD_BUTTON_PRESSED);
+	row++ ;
+	if(row == KEYPAD_NUM_OF_ROWS)
+	{
+		row = 0 ;
 
-			/* loop for columns */
-			for(col = 0 ; col < KEYPAD_NUM_OF_COLS ; col++)
+		/* A full matrix scan is completed, handle the auto-repeat of the held key */
+		if(g_repeatKeyIndex < KEYPAD_NUM_OF_KEYS)
+		{
+			g_repeatCounter++ ;
+			if(g_repeatCounter == KEYPAD_REPEAT_DELAY_SCANS)
 			{
-				/* Check if the switch is pressed in this column */
-				if(GPIO_readPin(KEYPAD_COL_PORT_ID, (KEYPAD_FIRST_COL_PIN_ID+col)) == KEYPAD_BUTTON_PRESSED)
-				{
-#if(KEYPAD_NUM_OF_COLS == 3)
-					return KEYPAD_4x3_adjustKeyNumber((row*KEYPAD_NUM_OF_COLS)+col+1);
-#elif(KEYPAD_NUM_OF_COLS == 4)
-					return KEYPAD_4x4_adjustKeyNumber((row*KEYPAD_NUM_OF_COLS)+col+1);
-#endif
-				}
+				KEYPAD_pushEvent(g_repeatKeyIndex, KEYPAD_EVENT_REPEAT);
+				g_repeatCounter = (KEYPAD_REPEAT_DELAY_SCANS - KEYPAD_REPEAT_RATE_SCANS) ;
 			}
+		}
 
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID,(KEYPAD_FIRST_ROW_PIN_ID+row),PIN_INPUT);
+		if(g_rowsBusy)
+		{
+			g_idleScans = 0 ;
 		}
+		else if(g_idleScans < KEYPAD_IDLE_SCANS)
+		{
+			g_idleScans++ ;
+		}
+	}
+
+	if(g_wakeupPending)
+	{
+		g_wakeupTicks++ ;
 	}
+	g_stats.scan_ticks++ ;
+
+#if(KEYPAD_IDLE_MODE_ENABLE == TRUE)
+	if(g_idleScans == KEYPAD_IDLE_SCANS)
+	{
+		/* A wake-up without any debounced press was a glitch, it has no latency to report */
+		g_wakeupPending = FALSE ;
+		g_stats.scan_cpu_time += Timer0_getCounter() ;
+		KEYPAD_enterIdle();
+		return ;
+	}
+#endif
+
+	KEYPAD_ROW_DDR_REG = ( KEYPAD_ROW_DDR_REG & ~KEYPAD_ROWS_MASK ) | (1<<(KEYPAD_FIRST_ROW_PIN_ID+row)) ;
+	g_scanRow = row ;
+
+	/* TCNT0 is cleared on the compare match, so it holds the time spent since the tick started */
+	g_stats.scan_cpu_time += Timer0_getCounter() ;
 }
 
-#if (KEYPAD_NUM_OF_COLS == 3)
-/*
- * Description :
- * Update the keypad pressed button value with the correct one in keypad 4x3 shape
+/* Inputs:
+ * 	1. Pointer to the event structure to be filled with the oldest key event.
+ *
+ * Return Value: TRUE if an event was read from the FIFO, FALSE if the FIFO is empty.
+ *
+ * Description:
+ *	Read the oldest key event without blocking.
  */
-static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number)
+boolean KEYPAD_pollEvent(KEYPAD_EventType *event)
 {
-	uint8 keypad_button = 0;
-	switch(button_number)
+	uint8 tail = g_eventTail ;
+
+	if(tail == g_eventHead)
 	{
-	case 10: keypad_button = '*'; // ASCII Code of *
-	break;
-	case 11: keypad_button = 0;
-	break;
-	case 12: keypad_button = '#'; // ASCII Code of #
-	break;
-	default: keypad_button = button_number;
-	break;
+		return FALSE ;
 	}
-	return keypad_button;
+
+	*event = g_eventQueue[tail & (KEYPAD_EVENT_QUEUE_SIZE - 1)] ;
+
+	/* Free the slot only after the event is copied, the ISR is the only writer of the head */
+	g_eventTail = tail + 1 ;
+
+	return TRUE ;
 }
 
-#elif (KEYPAD_NUM_OF_COLS == 4)
+/* Inputs:
+ * 	1. Bit mask of the event kinds to be queued, built by KEYPAD_EVENT_MASK().
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Select which events are queued in the FIFO, the other events are not reported.
+ *	All the events are queued by default.
+ */
+void KEYPAD_setEventFilter(uint8 mask)
+{
+	g_eventFilter = mask ;
+}
 
-/*
- * Description :
- * Update the keypad pressed button value with the correct one in keypad 4x4 shape
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Discard all the key events waiting in the FIFO.
+ */
+void KEYPAD_flushEvents(void)
+{
+	/* The application is the only writer of the tail */
+	g_eventTail = g_eventHead ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: Keypad pressed button value.
+ *
+ * Description:
+ *	Wait for the next debounced key press event and return its button value.
  */
-static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number)
+uint8 KEYPAD_getPressedKey(void)
+{
+	KEYPAD_EventType event ;
+
+	while(1)
+	{
+		if(KEYPAD_pollEvent(&event))
+		{
+			if(event.kind == KEYPAD_EVENT_PRESS)
+			{
+				return event.key ;
+			}
+		}
+		else
+		{
+			/* Sleep until the next interrupt, sei followed by sleep is atomic on AVR */
+			cli();
+			if(g_eventTail == g_eventHead)
+			{
+				sleep_enable();
+				sei();
+				sleep_cpu();
+				sleep_disable();
+			}
+			sei();
+		}
+	}
+}
+
+/* Inputs: void.
+ *
+ * Return Value: Bit mask of the debounced pressed keys, bit number is (row*KEYPAD_NUM_OF_COLS)+col.
+ *
+ * Description:
+ *	Read all the keys held at the same time (chord). Two keys are always detected correctly,
+ *	three keys at the corners of a rectangle may show the fourth one as a ghost key.
+ */
+uint16 KEYPAD_getPressedKeys(void)
+{
+	uint16 keys ;
+	uint8 sreg = SREG ;
+	cli();
+	keys = g_keysState ;
+	SREG = sreg ;
+	return keys ;
+}
+
+/* Inputs:
+ * 	1. The key bit number, (row*KEYPAD_NUM_OF_COLS)+col.
+ *
+ * Return Value: Keypad button value.
+ *
+ * Description:
+ *	Decode the key bit number to its button value through the keypad map table.
+ */
+uint8 KEYPAD_getKeyValue(uint8 key_index)
+{
+	return pgm_read_byte(&g_keypadMap[0][0] + key_index) ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the instrumentation counters.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the scan CPU time, wake-up and FIFO counters of the keypad scanner.
+ */
+void KEYPAD_getStats(KEYPAD_StatsType *stats)
+{
+	uint8 sreg = SREG ;
+	cli();
+	*stats = g_stats ;
+	SREG = sreg ;
+}
+
+static void KEYPAD_startScanning(void)
+{
+	/* Drive the first row, it will be sampled on the next tick after the lines settle */
+	g_scanRow = 0 ;
+	g_idleScans = 0 ;
+	KEYPAD_ROW_DDR_REG = ( KEYPAD_ROW_DDR_REG & ~KEYPAD_ROWS_MASK ) | (1<<KEYPAD_FIRST_ROW_PIN_ID) ;
+
+	Timer0_ConfigType Timer0_ConfigStruct ;
+	Timer0_ConfigStruct.mode = Timer0_Compare_Mode ;
+	Timer0_ConfigStruct.prescaler = Timer0_F_CPU_64 ;
+	Timer0_ConfigStruct.initial_value = 0 ;
+	Timer0_ConfigStruct.compare_value = KEYPAD_TIMER0_COMPARE_VALUE ;
+	Timer0_init(&Timer0_ConfigStruct);
+}
+
+#if(KEYPAD_IDLE_MODE_ENABLE == TRUE)
+static void KEYPAD_enterIdle(void)
 {
-	uint8 keypad_button = 0;
-	switch(button_number)
+	Timer0_deInit();
+
+	/* Drive all rows low, so any pressed key pulls its column and the wake-up pin low */
+	KEYPAD_ROW_DDR_REG |= KEYPAD_ROWS_MASK ;
+
+	ExtInt_ConfigType ExtInt_ConfigStruct ;
+	ExtInt_ConfigStruct.id = KEYPAD_WAKEUP_INT_ID ;
+	ExtInt_ConfigStruct.sense = ExtInt_Falling_Edge ;
+	ExtInt_ConfigStruct.pull_up = TRUE ;
+	ExtInt_init(&ExtInt_ConfigStruct);
+
+	/* A key pressed before the interrupt was armed did not generate an edge */
+	if(ExtInt_readPin(KEYPAD_WAKEUP_INT_ID) == KEYPAD_BUTTON_PRESSED)
 	{
-	case 1: keypad_button = 7;
-	break;
-	case 2: keypad_button = 8;
-	break;
-	case 3: keypad_button = 9;
-	break;
-	case 4: keypad_button = '%'; // ASCII Code of %
-	break;
-	case 5: keypad_button = 4;
-	break;
-	case 6: keypad_button = 5;
-	break;
-	case 7: keypad_button = 6;
-	break;
-	case 8: keypad_button = '*'; /* ASCII Code of '*' */
-	break;
-	case 9: keypad_button = 1;
-	break;
-	case 10: keypad_button = 2;
-	break;
-	case 11: keypad_button = 3;
-	break;
-	case 12: keypad_button = '-'; /* ASCII Code of '-' */
-	break;
-	case 13: keypad_button = 13;  /* ASCII of Enter */
-	break;
-	case 14: keypad_button = 0;
-	break;
-	case 15: keypad_button = '='; /* ASCII Code of '=' */
-	break;
-	case 16: keypad_button = '+'; /* ASCII Code of '+' */
-	break;
-	default: keypad_button = button_number;
-	break;
+		KEYPAD_wakeUp();
 	}
-	return keypad_button;
 }
 
+static void KEYPAD_wakeUp(void)
+{
+	ExtInt_deInit(KEYPAD_WAKEUP_INT_ID);
+
+	g_stats.wakeups++ ;
+	g_wakeupPending = TRUE ;
+	g_wakeupTicks = 0 ;
+
+	KEYPAD_startScanning();
+}
 #endif
+
+static void KEYPAD_pushEvent(uint8 key_index, KEYPAD_EventKind kind)
+{
+	uint8 head = g_eventHead ;
+
+	if(!(g_eventFilter & KEYPAD_EVENT_MASK(kind)))
+	{
+		return ;
+	}
+
+	if((uint8)(head - g_eventTail) == KEYPAD_EVENT_QUEUE_SIZE)
+	{
+		/* FIFO is full, drop the new event */
+		g_stats.dropped_events++ ;
+		return ;
+	}
+
+	g_eventQueue[head & (KEYPAD_EVENT_QUEUE_SIZE - 1)].key = KEYPAD_getKeyValue(key_index) ;
+	g_eventQueue[head & (KEYPAD_EVENT_QUEUE_SIZE - 1)].kind = kind ;
+
+	g_eventHead = head + 1 ;
+}
+
+static void KEYPAD_debounceKey(uint8 key_index, boolean raw_pressed)
+{
+	uint16 key_mask = ((uint16)1 << key_index) ;
+
+	if(raw_pressed)
+	{
+		if(g_debounceCounter[key_index] < KEYPAD_DEBOUNCE_SCANS)
+		{
+			g_debounceCounter[key_index]++ ;
+			if((g_debounceCounter[key_index] == KEYPAD_DEBOUNCE_SCANS) && !(g_keysState & key_mask))
+			{
+				g_keysState |= key_mask ;
+				g_repeatKeyIndex = key_index ;
+				g_repeatCounter = 0 ;
+				KEYPAD_pushEvent(key_index, KEYPAD_EVENT_PRESS);
+
+				/* More than one key is held */
+				if(g_keysState & (g_keysState - 1))
+				{
+					KEYPAD_pushEvent(key_index, KEYPAD_EVENT_CHORD);
+				}
+
+				if(g_wakeupPending)
+				{
+					g_wakeupPending = FALSE ;
+					g_stats.last_wakeup_latency = (g_wakeupTicks * KEYPAD_SCAN_TICK_MS) ;
+					if(g_stats.last_wakeup_latency > g_stats.max_wakeup_latency)
+					{
+						g_stats.max_wakeup_latency = g_stats.last_wakeup_latency ;
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		if(g_debounceCounter[key_index] > 0)
+		{
+			g_debounceCounter[key_index]-- ;
+			if((g_debounceCounter[key_index] == 0) && (g_keysState & key_mask))
+			{
+				g_keysState &= ~key_mask ;
+				if(g_repeatKeyIndex == key_index)
+				{
+					g_repeatKeyIndex = KEYPAD_NUM_OF_KEYS ;
+				}
+				KEYPAD_pushEvent(key_index, KEYPAD_EVENT_RELEASE);
+			}
+		}
+	}
+}
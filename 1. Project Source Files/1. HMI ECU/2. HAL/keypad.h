@@ -23,6 +23,8 @@
 #define KEYPAD_NUM_OF_COLS                   4
 #define KEYPAD_NUM_OF_ROWS                   4
 
+#define KEYPAD_NUM_OF_KEYS                (KEYPAD_NUM_OF_ROWS * KEYPAD_NUM_OF_COLS)
+
 /* Keypad Port Configurations */
 #define KEYPAD_ROW_PORT_ID                PORTC_ID
 #define KEYPAD_FIRST_ROW_PIN_ID           PIN0_ID
@@ -30,21 +32,216 @@
 #define KEYPAD_COL_PORT_ID                PORTC_ID
 #define KEYPAD_FIRST_COL_PIN_ID           PIN4_ID
 
+/*
+ * Keypad registers, the scanner accesses them directly so one row costs a DDR write and
+ * a single PIN read. The rows and the columns pins must be consecutive in their ports.
+ * The registers follow the rows and the columns port IDs.
+ */
+#if(KEYPAD_ROW_PORT_ID == PORTA_ID)
+#define KEYPAD_ROW_DDR_REG                  DDRA
+#elif(KEYPAD_ROW_PORT_ID == PORTB_ID)
+#define KEYPAD_ROW_DDR_REG                  DDRB
+#elif(KEYPAD_ROW_PORT_ID == PORTC_ID)
+#define KEYPAD_ROW_DDR_REG                  DDRC
+#elif(KEYPAD_ROW_PORT_ID == PORTD_ID)
+#define KEYPAD_ROW_DDR_REG                  DDRD
+#else
+#error "Invalid keypad rows port ID"
+#endif
+
+#if(KEYPAD_COL_PORT_ID == PORTA_ID)
+#define KEYPAD_COL_PIN_REG                  PINA
+#elif(KEYPAD_COL_PORT_ID == PORTB_ID)
+#define KEYPAD_COL_PIN_REG                  PINB
+#elif(KEYPAD_COL_PORT_ID == PORTC_ID)
+#define KEYPAD_COL_PIN_REG                  PINC
+#elif(KEYPAD_COL_PORT_ID == PORTD_ID)
+#define KEYPAD_COL_PIN_REG                  PIND
+#else
+#error "Invalid keypad columns port ID"
+#endif
+
+#define KEYPAD_ROWS_MASK                  ((uint8)(((1<<KEYPAD_NUM_OF_ROWS)-1) << KEYPAD_FIRST_ROW_PIN_ID))
+#define KEYPAD_COLS_MASK                  ((uint8)((1<<KEYPAD_NUM_OF_COLS)-1))
+
 /* Keypad button logic configurations */
 #define KEYPAD_BUTTON_PRESSED            LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED           LOGIC_HIGH
 
+/*
+ * Scanner timing configurations, one row is scanned every tick so a full matrix
+ * scan takes (KEYPAD_NUM_OF_ROWS * KEYPAD_SCAN_TICK_MS) = 4ms.
+ * The tick is generated by Timer0 in compare mode: F_CPU/64 and OCR0 = 124 gives 1ms at 8MHz.
+ */
+#define KEYPAD_SCAN_TICK_MS                  1
+#define KEYPAD_TIMER0_COMPARE_VALUE        ((uint8)(((F_CPU / 64UL) * KEYPAD_SCAN_TICK_MS / 1000UL) - 1))
+
+/* A key must be stable for this number of full scans before a press/release is reported (20ms) */
+#define KEYPAD_DEBOUNCE_SCANS                5
+
+/* A held key starts repeating after 500ms then repeats every 100ms (values in full scans) */
+#define KEYPAD_REPEAT_DELAY_SCANS          125
+#define KEYPAD_REPEAT_RATE_SCANS            25
+
+/* Number of key events that can wait in the FIFO, it must be a power of 2 up to 128 */
+#define KEYPAD_EVENT_QUEUE_SIZE             16
+
+#if((KEYPAD_EVENT_QUEUE_SIZE & (KEYPAD_EVENT_QUEUE_SIZE - 1)) != 0) || (KEYPAD_EVENT_QUEUE_SIZE > 128)
+#error "The keypad events FIFO size must be a power of 2 up to 128"
+#endif
+
+/*
+ * Idle mode configurations, after KEYPAD_IDLE_SCANS full scans (100ms) without any key
+ * the scanner stops, all rows are driven low and the ECU waits for the wake-up interrupt.
+ * The columns are wired to the wake-up pin through diodes (wired-OR of active low lines),
+ * so any pressed key pulls INT0 (PD2) low.
+ */
+#define KEYPAD_IDLE_MODE_ENABLE              TRUE
+#define KEYPAD_IDLE_SCANS                   25
+#define KEYPAD_WAKEUP_INT_ID              ExtInt_INT0
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef enum
+{
+	KEYPAD_EVENT_PRESS,
+
+	KEYPAD_EVENT_RELEASE,
+
+	KEYPAD_EVENT_REPEAT,
+
+	/* The key is pressed while another key is held, read the whole set by KEYPAD_getPressedKeys() */
+	KEYPAD_EVENT_CHORD
+
+}KEYPAD_EventKind;
+
+typedef struct
+{
+	uint8 key ;
+
+	KEYPAD_EventKind kind ;
+
+}KEYPAD_EventType;
+
+/* Bit mask of an event kind, used to select which events are queued in the FIFO */
+#define KEYPAD_EVENT_MASK(kind)           ((uint8)(1<<(kind)))
+#define KEYPAD_ALL_EVENTS                 ((uint8)0xFF)
+
+/* Keypad instrumentation counters */
+typedef struct
+{
+	/* Number of row scans executed by the Timer0 tick */
+	uint32 scan_ticks ;
+
+	/* Accumulated scan time in Timer0 counts, every count is 64 CPU cycles (8us at 8MHz) */
+	uint32 scan_cpu_time ;
+
+	/* Number of wake-ups from the idle mode */
+	uint16 wakeups ;
+
+	/* Time from the wake-up interrupt to the first debounced press event in ms */
+	uint16 last_wakeup_latency ;
+	uint16 max_wakeup_latency ;
+
+	/* Number of key events dropped because the FIFO was full */
+	uint16 dropped_events ;
+
+}KEYPAD_StatsType;
+
 /****************************************************************************
  * 							Functions Prototypes						    *
  ****************************************************************************/
 
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Setup the rows/columns pins once and start the Timer0 tick that scans one
+ *	keypad row every KEYPAD_SCAN_TICK_MS in the background.
+ */
+void KEYPAD_init(void);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Scan one row of the keypad, debounce its keys and push the press/release/repeat/chord
+ *	events into the key event FIFO. It is called from the Timer0 interrupt.
+ */
+void KEYPAD_scanTick(void);
+
+/* Inputs:
+ * 	1. Pointer to the event structure to be filled with the oldest key event.
+ *
+ * Return Value: TRUE if an event was read from the FIFO, FALSE if the FIFO is empty.
+ *
+ * Description:
+ *	Read the oldest key event without blocking.
+ */
+boolean KEYPAD_pollEvent(KEYPAD_EventType *event);
+
+/* Inputs:
+ * 	1. Bit mask of the event kinds to be queued, built by KEYPAD_EVENT_MASK().
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Select which events are queued in the FIFO, the other events are not reported.
+ *	All the events are queued by default.
+ */
+void KEYPAD_setEventFilter(uint8 mask);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Discard all the key events waiting in the FIFO.
+ */
+void KEYPAD_flushEvents(void);
+
 /* Inputs: void.
  *
  * Return Value: Keypad pressed button value.
  *
  * Description:
- *	Get the Keypad pressed button.
+ *	Wait for the next debounced key press event and return its button value.
+ *	The CPU sleeps (idle sleep mode) while the FIFO is empty.
  */
 uint8 KEYPAD_getPressedKey(void);
 
+/* Inputs: void.
+ *
+ * Return Value: Bit mask of the debounced pressed keys, bit number is (row*KEYPAD_NUM_OF_COLS)+col.
+ *
+ * Description:
+ *	Read all the keys held at the same time (chord). Two keys are always detected correctly,
+ *	three keys at the corners of a rectangle may show the fourth one as a ghost key.
+ */
+uint16 KEYPAD_getPressedKeys(void);
+
+/* Inputs:
+ * 	1. The key bit number, (row*KEYPAD_NUM_OF_COLS)+col.
+ *
+ * Return Value: Keypad button value.
+ *
+ * Description:
+ *	Decode the key bit number to its button value through the keypad map table.
+ */
+uint8 KEYPAD_getKeyValue(uint8 key_index);
+
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the instrumentation counters.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the scan CPU time, wake-up and FIFO counters of the keypad scanner.
+ */
+void KEYPAD_getStats(KEYPAD_StatsType *stats);
+
 #endif /* KEYPAD_H_ */
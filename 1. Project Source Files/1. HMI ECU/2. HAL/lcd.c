@@ -16,6 +16,22 @@
 #include "gpio.h"
 #include "common_macros.h"
 
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for writing one byte to the LCD in the register selected by RS.
+ */
+static void LCD_writeByte(uint8 rs_value, uint8 data);
+
+#if(LCD_TWO_LINES_FOUR_BITS_MODE == LCD_DATA_BITS_MODE)
+/*
+ * Function responsible for writing the lower 4 bits of the nibble to the data bus by one enable pulse.
+ */
+static void LCD_writeNibble(uint8 nibble);
+#endif
+
 /****************************************************************************
  * 							Functions Definitions						    *
  ****************************************************************************/
@@ -36,7 +52,7 @@ void LCD_init(void)
 	GPIO_setupPinDirection(LCD_E_PORT_ID, LCD_E_PIN_ID, PIN_OUTPUT);
 
 	/* LCD Power ON delay always > 15ms */
-	_delay_ms(20);
+	_delay_ms(LCD_POWER_ON_TIME_MS);
 
 	/* Configure the data port as output port */
 #if(LCD_TWO_LINES_EIGHT_BITS_MODE == LCD_DATA_BITS_MODE)
@@ -47,9 +63,19 @@ void LCD_init(void)
 	GPIO_setupPinDirection(LCD_DATA_PORT_ID, LCD_DATA_PIN3_ID, PIN_OUTPUT);
 	GPIO_setupPinDirection(LCD_DATA_PORT_ID, LCD_DATA_PIN4_ID, PIN_OUTPUT);
 
-	/* Send for 4 bit initialization of LCD  */
-	LCD_sendCommand(LCD_TWO_LINES_FOUR_BITS_MODE_INIT1);
-	LCD_sendCommand(LCD_TWO_LINES_FOUR_BITS_MODE_INIT2);
+	/*
+	 * Send for 4 bit initialization of LCD, the LCD may be in 8-bit mode so every nibble
+	 * is one instruction and it waits the reset sequence times.
+	 */
+	GPIO_writePin(LCD_RS_PORT_ID, LCD_RS_PIN_ID, LOGIC_LOW);
+	LCD_writeNibble(LCD_TWO_LINES_FOUR_BITS_MODE_INIT1 >> 4);
+	_delay_ms(LCD_RESET_FIRST_TIME_MS);
+	LCD_writeNibble(LCD_TWO_LINES_FOUR_BITS_MODE_INIT1);
+	_delay_us(LCD_RESET_SECOND_TIME_US);
+	LCD_writeNibble(LCD_TWO_LINES_FOUR_BITS_MODE_INIT2 >> 4);
+	_delay_us(LCD_EXECUTION_TIME_US);
+	LCD_writeNibble(LCD_TWO_LINES_FOUR_BITS_MODE_INIT2);
+	_delay_us(LCD_EXECUTION_TIME_US);
 #endif
 
 	/* Send LCD display mode command. */
@@ -74,59 +100,17 @@ void LCD_init(void)
 void LCD_sendCommand(uint8 command)
 {
 	/* Instruction Mode RS=0 */
-	GPIO_writePin(LCD_RS_PORT_ID, LCD_RS_PIN_ID, LOGIC_LOW);
-	/* delay for processing Tas = 50ns */
-	_delay_ms(1);
-
-	/* Enable LCD E=1 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_HIGH);
-	/* delay for processing Tpw - Tdws = 190ns */
-	_delay_ms(1);
-
-#if(LCD_TWO_LINES_EIGHT_BITS_MODE == LCD_DATA_BITS_MODE)
-	/* out the required command to the data bus D0 --> D7 */
-	GPIO_writePort(LCD_DATA_PORT_ID, command);
-	/* delay for processing Tdsw = 100ns */
-	_delay_ms(1);
-
-	/* Disable LCD E=0 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
-	/* delay for processing Th = 13ns */
-	_delay_ms(1);
-#elif(LCD_TWO_LINES_FOUR_BITS_MODE == LCD_DATA_BITS_MODE)
-	/* out the higher 4 bits of required command to the data bus */
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN1_ID, GET_BIT(command,4));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN2_ID, GET_BIT(command,5));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN3_ID, GET_BIT(command,6));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN4_ID, GET_BIT(command,7));
-
-	/* delay for processing Tdsw = 100ns */
-	_delay_ms(1);
+	LCD_writeByte(LOGIC_LOW, command);
 
-	/* Disable LCD E=0 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
-	/* delay for processing Th = 13ns */
-	_delay_ms(1);
-
-	/* Enable LCD E=1 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_HIGH);
-	/* delay for processing Tpw - Tdws = 190ns */
-	_delay_ms(1);
-
-	/* out the lower 4 bits of required command to the data bus */
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN1_ID, GET_BIT(command,0));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN2_ID, GET_BIT(command,1));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN3_ID, GET_BIT(command,2));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN4_ID, GET_BIT(command,3));
-
-	/* delay for processing Tdsw = 100ns */
-	_delay_ms(1);
-
-	/* Disable LCD E=0 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
-	/* delay for processing Th = 13ns */
-	_delay_ms(1);
-#endif
+	/* Wait for the command execution, the clear and home commands are the long ones */
+	if((command == LCD_CLEAR_COMMAND) || (command == LCD_GO_TO_HOME))
+	{
+		_delay_ms(LCD_CLEAR_TIME_MS);
+	}
+	else
+	{
+		_delay_us(LCD_EXECUTION_TIME_US);
+	}
 }
 
 /* Inputs:
@@ -140,59 +124,10 @@ void LCD_sendCommand(uint8 command)
 void LCD_displayCharacter(uint8 data)
 {
 	/* Data Mode RS=1 */
-	GPIO_writePin(LCD_RS_PORT_ID, LCD_RS_PIN_ID, LOGIC_HIGH);
-	/* delay for processing Tas = 50ns */
-	_delay_ms(1);
+	LCD_writeByte(LOGIC_HIGH, data);
 
-	/* Enable LCD E=1 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_HIGH);
-	/* delay for processing Tpw - Tdws = 190ns */
-	_delay_ms(1);
-
-#if(LCD_TWO_LINES_EIGHT_BITS_MODE == LCD_DATA_BITS_MODE)
-	/* out the required data to the data bus D0 --> D7 */
-	GPIO_writePort(LCD_DATA_PORT_ID, data);
-	/* delay for processing Tdsw = 100ns */
-	_delay_ms(1);
-
-	/* Disable LCD E=0 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
-	/* delay for processing Th = 13ns */
-	_delay_ms(1);
-#elif(LCD_TWO_LINES_FOUR_BITS_MODE == LCD_DATA_BITS_MODE)
-	/* out the higher 4 bits of required data to the data bus */
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN1_ID, GET_BIT(data,4));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN2_ID, GET_BIT(data,5));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN3_ID, GET_BIT(data,6));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN4_ID, GET_BIT(data,7));
-
-	/* delay for processing Tdsw = 100ns */
-	_delay_ms(1);
-
-	/* Disable LCD E=0 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
-	/* delay for processing Th = 13ns */
-	_delay_ms(1);
-
-	/* Enable LCD E=1 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_HIGH);
-	/* delay for processing Tpw - Tdws = 190ns */
-	_delay_ms(1);
-
-	/* out the lower 4 bits of required data to the data bus */
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN1_ID, GET_BIT(data,0));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN2_ID, GET_BIT(data,1));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN3_ID, GET_BIT(data,2));
-	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN4_ID, GET_BIT(data,3));
-
-	/* delay for processing Tdsw = 100ns */
-	_delay_ms(1);
-
-	/* Disable LCD E=0 */
-	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
-	/* delay for processing Th = 13ns */
-	_delay_ms(1);
-#endif
+	/* Wait for the data write execution */
+	_delay_us(LCD_EXECUTION_TIME_US);
 }
 
 /* Inputs:
@@ -299,3 +234,52 @@ void LCD_integerToString(int data)
 	LCD_displayString(buff);
 }
 
+static void LCD_writeByte(uint8 rs_value, uint8 data)
+{
+	GPIO_writePin(LCD_RS_PORT_ID, LCD_RS_PIN_ID, rs_value);
+	/* delay for processing Tas = 50ns */
+	_delay_us(LCD_BUS_TIME_US);
+
+#if(LCD_TWO_LINES_EIGHT_BITS_MODE == LCD_DATA_BITS_MODE)
+	/* Enable LCD E=1 */
+	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_HIGH);
+	/* delay for processing Tpw - Tdws = 190ns */
+	_delay_us(LCD_BUS_TIME_US);
+
+	/* out the required byte to the data bus D0 --> D7 */
+	GPIO_writePort(LCD_DATA_PORT_ID, data);
+	/* delay for processing Tdsw = 100ns */
+	_delay_us(LCD_BUS_TIME_US);
+
+	/* Disable LCD E=0 */
+	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
+	/* delay for processing Th = 13ns */
+	_delay_us(LCD_BUS_TIME_US);
+#elif(LCD_TWO_LINES_FOUR_BITS_MODE == LCD_DATA_BITS_MODE)
+	/* out the higher 4 bits then the lower 4 bits of the required byte */
+	LCD_writeNibble(data >> 4);
+	LCD_writeNibble(data);
+#endif
+}
+
+#if(LCD_TWO_LINES_FOUR_BITS_MODE == LCD_DATA_BITS_MODE)
+static void LCD_writeNibble(uint8 nibble)
+{
+	/* Enable LCD E=1 */
+	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_HIGH);
+	/* delay for processing Tpw - Tdws = 190ns */
+	_delay_us(LCD_BUS_TIME_US);
+
+	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN1_ID, GET_BIT(nibble,0));
+	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN2_ID, GET_BIT(nibble,1));
+	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN3_ID, GET_BIT(nibble,2));
+	GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_PIN4_ID, GET_BIT(nibble,3));
+	/* delay for processing Tdsw = 100ns */
+	_delay_us(LCD_BUS_TIME_US);
+
+	/* Disable LCD E=0 */
+	GPIO_writePin(LCD_E_PORT_ID, LCD_E_PIN_ID, LOGIC_LOW);
+	/* delay for processing Th = 13ns */
+	_delay_us(LCD_BUS_TIME_US);
+}
+#endif
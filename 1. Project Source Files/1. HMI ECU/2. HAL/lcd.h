@@ -33,6 +33,17 @@
 
 #define LCD_DATA_BITS_MODE 			         (LCD_TWO_LINES_FOUR_BITS_MODE)
 
+/*
+ * LCD timing, the bus setup and hold times are below 1us and every command waits only its
+ * execution time, so the init and the screen redraws do not wait milliseconds per byte.
+ */
+#define LCD_POWER_ON_TIME_MS                 20
+#define LCD_RESET_FIRST_TIME_MS              5
+#define LCD_RESET_SECOND_TIME_US             150
+#define LCD_BUS_TIME_US                      1
+#define LCD_EXECUTION_TIME_US                50
+#define LCD_CLEAR_TIME_MS                    2
+
 /* LCD HW Ports and Pins IDs */
 #define LCD_RS_PORT_ID                 		 PORTA_ID
 #define LCD_RS_PIN_ID                        PIN4_ID
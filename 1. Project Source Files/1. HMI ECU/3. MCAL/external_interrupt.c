@@ -0,0 +1,171 @@
+/*
+ ============================================================================
+ Name        : external_interrupt.c
+ Author      : Ahmed Shawky
+ Description : Source File for External Interrupts (INT0/INT1/INT2) Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "external_interrupt.h"
+#include "gpio.h"
+#include "common_macros.h"
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Global variables to hold the address of the call back functions in the application */
+static void (*volatile g_callBackPtr[3])(void) = { NULL_PTR, NULL_PTR, NULL_PTR } ;
+
+/****************************************************************************
+ * 						 Interrupt Service Routines							*
+ ****************************************************************************/
+ISR(INT0_vect)
+{
+	if(g_callBackPtr[ExtInt_INT0] != NULL_PTR)
+	{
+		g_callBackPtr[ExtInt_INT0]();
+	}
+}
+
+ISR(INT1_vect)
+{
+	if(g_callBackPtr[ExtInt_INT1] != NULL_PTR)
+	{
+		g_callBackPtr[ExtInt_INT1]();
+	}
+}
+
+ISR(INT2_vect)
+{
+	if(g_callBackPtr[ExtInt_INT2] != NULL_PTR)
+	{
+		g_callBackPtr[ExtInt_INT2]();
+	}
+}
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : ExtInt_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Setup the interrupt pin as input (with or without the internal pull-up),
+ *	select its sense control, clear any old pending flag and enable the interrupt.
+ */
+void ExtInt_init(const ExtInt_ConfigType *Config_Ptr)
+{
+	uint8 pull_up = (Config_Ptr->pull_up) ? LOGIC_HIGH : LOGIC_LOW ;
+
+	switch(Config_Ptr->id)
+	{
+	case ExtInt_INT0 :
+		GPIO_setupPinDirection(PORTD_ID, PIN2_ID, PIN_INPUT);
+		GPIO_writePin(PORTD_ID, PIN2_ID, pull_up);
+		MCUCR = ( MCUCR & 0xFC ) | ( Config_Ptr->sense << ISC00 ) ;
+		GIFR = (1<<INTF0) ;
+		SET_BIT(GICR,INT0);
+		break;
+	case ExtInt_INT1 :
+		GPIO_setupPinDirection(PORTD_ID, PIN3_ID, PIN_INPUT);
+		GPIO_writePin(PORTD_ID, PIN3_ID, pull_up);
+		MCUCR = ( MCUCR & 0xF3 ) | ( Config_Ptr->sense << ISC10 ) ;
+		GIFR = (1<<INTF1) ;
+		SET_BIT(GICR,INT1);
+		break;
+	case ExtInt_INT2 :
+		GPIO_setupPinDirection(PORTB_ID, PIN2_ID, PIN_INPUT);
+		GPIO_writePin(PORTB_ID, PIN2_ID, pull_up);
+
+		/* The interrupt must be disabled while changing ISC2 then the flag is cleared */
+		CLEAR_BIT(GICR,INT2);
+		if(Config_Ptr->sense == ExtInt_Rising_Edge)
+		{
+			SET_BIT(MCUCSR,ISC2);
+		}
+		else
+		{
+			CLEAR_BIT(MCUCSR,ISC2);
+		}
+		GIFR = (1<<INTF2) ;
+		SET_BIT(GICR,INT2);
+		break;
+	}
+}
+
+/* Inputs:
+ * 	1. The required external interrupt ID.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Disable the required external interrupt.
+ */
+void ExtInt_deInit(ExtInt_ID id)
+{
+	switch(id)
+	{
+	case ExtInt_INT0 :
+		CLEAR_BIT(GICR,INT0);
+		break;
+	case ExtInt_INT1 :
+		CLEAR_BIT(GICR,INT1);
+		break;
+	case ExtInt_INT2 :
+		CLEAR_BIT(GICR,INT2);
+		break;
+	}
+}
+
+/* Inputs:
+ * 	1. The required external interrupt ID.
+ *
+ * Return Value: pin value it should be LOGIC_HIGH or LOGIC_LOW.
+ *
+ * Description:
+ *	Read the current level of the external interrupt pin.
+ */
+uint8 ExtInt_readPin(ExtInt_ID id)
+{
+	uint8 value = LOGIC_LOW ;
+
+	switch(id)
+	{
+	case ExtInt_INT0 :
+		value = GPIO_readPin(PORTD_ID, PIN2_ID);
+		break;
+	case ExtInt_INT1 :
+		value = GPIO_readPin(PORTD_ID, PIN3_ID);
+		break;
+	case ExtInt_INT2 :
+		value = GPIO_readPin(PORTB_ID, PIN2_ID);
+		break;
+	}
+
+	return value ;
+}
+
+/* Inputs:
+ * 	1. The required external interrupt ID.
+ * 	2. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address of the required interrupt.
+ */
+void ExtInt_setCallBack(ExtInt_ID id, void(*a_ptr)(void))
+{
+	/* Save the address of the Call back function in a global variable */
+	g_callBackPtr[id] = a_ptr ;
+}
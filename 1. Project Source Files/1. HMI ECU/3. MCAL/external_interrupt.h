@@ -0,0 +1,102 @@
+/*
+ ============================================================================
+ Name        : external_interrupt.h
+ Author      : Ahmed Shawky
+ Description : Header File for External Interrupts (INT0/INT1/INT2) Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef EXTERNAL_INTERRUPT_H_
+#define EXTERNAL_INTERRUPT_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+/* INT0 is PD2, INT1 is PD3 and INT2 is PB2 */
+typedef enum
+{
+	ExtInt_INT0,
+
+	ExtInt_INT1,
+
+	ExtInt_INT2
+
+}ExtInt_ID;
+
+/* INT2 supports the falling and rising edges only */
+typedef enum
+{
+	ExtInt_Low_Level,
+
+	ExtInt_Any_Change,
+
+	ExtInt_Falling_Edge,
+
+	ExtInt_Rising_Edge
+
+}ExtInt_Sense;
+
+typedef struct
+{
+	ExtInt_ID id ;
+
+	ExtInt_Sense sense ;
+
+	boolean pull_up ;
+
+}ExtInt_ConfigType;
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : ExtInt_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Setup the interrupt pin as input (with or without the internal pull-up),
+ *	select its sense control, clear any old pending flag and enable the interrupt.
+ */
+void ExtInt_init(const ExtInt_ConfigType *Config_Ptr);
+
+/* Inputs:
+ * 	1. The required external interrupt ID.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Disable the required external interrupt.
+ */
+void ExtInt_deInit(ExtInt_ID id);
+
+/* Inputs:
+ * 	1. The required external interrupt ID.
+ *
+ * Return Value: pin value it should be LOGIC_HIGH or LOGIC_LOW.
+ *
+ * Description:
+ *	Read the current level of the external interrupt pin.
+ */
+uint8 ExtInt_readPin(ExtInt_ID id);
+
+/* Inputs:
+ * 	1. The required external interrupt ID.
+ * 	2. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address of the required interrupt.
+ */
+void ExtInt_setCallBack(ExtInt_ID id, void(*a_ptr)(void));
+
+#endif /* EXTERNAL_INTERRUPT_H_ */
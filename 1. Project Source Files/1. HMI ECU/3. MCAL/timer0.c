@@ -0,0 +1,145 @@
+/*
+ ============================================================================
+ Name        : timer0.c
+ Author      : Ahmed Shawky
+ Description : Source File for Timer0 Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "timer0.h"
+#include "common_macros.h"
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Global variables to hold the address of the call back function in the application */
+static void (*volatile g_callBackPtr)(void) = NULL_PTR ;
+
+
+/****************************************************************************
+ * 						 Interrupt Service Routines							*
+ ****************************************************************************/
+ISR(TIMER0_OVF_vect)
+{
+	if(g_callBackPtr != NULL_PTR)
+	{
+		g_callBackPtr();
+	}
+}
+
+ISR(TIMER0_COMP_vect)
+{
+	if(g_callBackPtr != NULL_PTR)
+	{
+		g_callBackPtr();
+	}
+}
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : Timer0_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start Timer0 in normal (overflow) or compare (CTC) mode with the required
+ *	prescaler, the interrupt of the selected mode is enabled and calls the
+ *	Call Back function on every overflow/compare match.
+ */
+void Timer0_init(const Timer0_ConfigType *Config_Ptr)
+{
+	uint8 sreg ;
+
+	/* Stop the clock while the timer is being configured */
+	TCCR0 = 0 ;
+
+	switch(Config_Ptr->mode)
+	{
+	case Timer0_Normal_Mode :
+
+		/* Normal port operation OC0 disconnected, non-PWM mode */
+		TCCR0 = (1<<FOC0) ;
+
+		/* TIMSK is shared by all the timers, it is changed from their interrupts too */
+		sreg = SREG ;
+		cli();
+		CLEAR_BIT(TIMSK,OCIE0);
+		SET_BIT(TIMSK,TOIE0);
+		SREG = sreg ;
+		break;
+	case Timer0_Compare_Mode :
+
+		/* Normal port operation OC0 disconnected, clear timer on compare match */
+		TCCR0 = (1<<FOC0) | (1<<WGM01) ;
+
+		OCR0 = Config_Ptr->compare_value ;
+
+		sreg = SREG ;
+		cli();
+		CLEAR_BIT(TIMSK,TOIE0);
+		SET_BIT(TIMSK,OCIE0);
+		SREG = sreg ;
+		break;
+	}
+
+	TCNT0 = Config_Ptr->initial_value ;
+
+	/* Start the clock with the required prescaler */
+	TCCR0 = ( TCCR0 & 0xF8 ) | ( Config_Ptr->prescaler & 0x07 ) ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop Timer0 and disable its interrupts only, the other timers are not affected.
+ */
+void Timer0_deInit(void)
+{
+	uint8 sreg ;
+
+	TCCR0 = 0 ;
+	sreg = SREG ;
+	cli();
+	TIMSK &= ~((1<<TOIE0) | (1<<OCIE0)) ;
+	SREG = sreg ;
+	TCNT0 = 0 ;
+	OCR0 = 0 ;
+}
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address.
+ */
+void Timer0_setCallBack(void(*a_ptr)(void))
+{
+	/* Save the address of the Call back function in a global variable */
+	g_callBackPtr = a_ptr ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The current Timer0 counter value.
+ *
+ * Description:
+ *	Read TCNT0, in compare mode it is the time elapsed since the last compare match.
+ */
+uint8 Timer0_getCounter(void)
+{
+	return TCNT0 ;
+}
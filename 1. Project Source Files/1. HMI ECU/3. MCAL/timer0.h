@@ -0,0 +1,102 @@
+/*
+ ============================================================================
+ Name        : timer0.h
+ Author      : Ahmed Shawky
+ Description : Header File for Timer0 Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef TIMER0_H_
+#define TIMER0_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef enum
+{
+	Timer0_F_CPU_1 = 0x01,
+
+	Timer0_F_CPU_8,
+
+	Timer0_F_CPU_64,
+
+	Timer0_F_CPU_256,
+
+	Timer0_F_CPU_1024
+
+}Timer0_Prescaler;
+
+typedef enum
+{
+	Timer0_Normal_Mode,
+
+	Timer0_Compare_Mode
+
+}Timer0_Mode;
+
+typedef struct
+{
+	uint8 initial_value ;
+
+	uint8 compare_value ;
+
+	Timer0_Prescaler prescaler ;
+
+	Timer0_Mode mode ;
+
+}Timer0_ConfigType;
+
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : Timer0_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start Timer0 in normal (overflow) or compare (CTC) mode with the required
+ *	prescaler, the interrupt of the selected mode is enabled and calls the
+ *	Call Back function on every overflow/compare match.
+ */
+void Timer0_init(const Timer0_ConfigType *Config_Ptr);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop Timer0 and disable its interrupts only, the other timers are not affected.
+ */
+void Timer0_deInit(void);
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address.
+ */
+void Timer0_setCallBack(void(*a_ptr)(void));
+
+/* Inputs: void.
+ *
+ * Return Value: The current Timer0 counter value.
+ *
+ * Description:
+ *	Read TCNT0, in compare mode it is the time elapsed since the last compare match.
+ */
+uint8 Timer0_getCounter(void);
+
+
+#endif /* TIMER0_H_ */
@@ -59,6 +59,8 @@ ISR(TIMER1_COMPA_vect)
  */
 void Timer1_init(const Timer1_ConfigType *Config_Ptr)
 {
+	uint8 sreg ;
+
 	switch(Config_Ptr->mode)
 	{
 	case Timer1_Normal_Mode :
@@ -75,7 +77,11 @@ void Timer1_init(const Timer1_ConfigType *Config_Ptr)
 		CLEAR_BIT(TCCR1B,WGM12);
 		CLEAR_BIT(TCCR1B,WGM13);
 
+		/* TIMSK is shared by all the timers, it is changed from their interrupts too */
+		sreg = SREG ;
+		cli();
 		SET_BIT(TIMSK,TOIE1);
+		SREG = sreg ;
 		break;
 	case Timer1_Compare_Mode :
 
@@ -91,7 +97,10 @@ void Timer1_init(const Timer1_ConfigType *Config_Ptr)
 		SET_BIT(TCCR1B,WGM12);
 		CLEAR_BIT(TCCR1B,WGM13);
 
+		sreg = SREG ;
+		cli();
 		SET_BIT(TIMSK,OCIE1A);
+		SREG = sreg ;
 		break;
 	case Timer1_PWM_Mode :
 
@@ -141,9 +150,16 @@ void Timer1_init(const Timer1_ConfigType *Config_Ptr)
  */
 void Timer1_deInit(void)
 {
+	uint8 sreg ;
+
 	TCCR1A = 0 ;
 	TCCR1B = 0 ;
-	TIMSK = 0 ;
+
+	/* Disable the Timer1 interrupts only, Timer0/Timer2 may still be running */
+	sreg = SREG ;
+	cli();
+	TIMSK &= ~((1<<TOIE1) | (1<<OCIE1A)) ;
+	SREG = sreg ;
 	TCNT1 = 0 ;
 
 #if(TIMER1_SELECTED_MODE == TIMER1_COMPARE_MODE)
@@ -11,6 +11,27 @@
  * 								  Includes								    *
  ****************************************************************************/
 #include "uart.h"
+#include "gpio.h"
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for writing a frame to UDR, it enables the RS-485 driver first.
+ */
+static void UART_writeFrame(uint8 data);
+
+/****************************************************************************
+ * 						 Interrupt Service Routines							*
+ ****************************************************************************/
+#if(UART_RS485_ENABLE == TRUE)
+ISR(USART_TXC_vect)
+{
+	/* The last frame is out and no frame is waiting in UDR, the bus is released */
+	GPIO_writePin(UART_RS485_DE_PORT_ID, UART_RS485_DE_PIN_ID, LOGIC_LOW);
+}
+#endif
 
 /****************************************************************************
  * 							Functions Definitions						    *
@@ -32,6 +53,13 @@ void UART_init(const UART_ConfigType *Config_Ptr)
 
 	UCSRB |= (1<<RXEN) | (1<<TXEN) ;
 
+#if(UART_RS485_ENABLE == TRUE)
+	/* The driver is released until the first frame */
+	GPIO_setupPinDirection(UART_RS485_DE_PORT_ID, UART_RS485_DE_PIN_ID, PIN_OUTPUT);
+	GPIO_writePin(UART_RS485_DE_PORT_ID, UART_RS485_DE_PIN_ID, LOGIC_LOW);
+	SET_BIT(UCSRB,TXCIE);
+#endif
+
 	UCSRC |= (1<<URSEL) ;
 
 	switch(Config_Ptr->bit_data)
@@ -104,7 +132,7 @@ void UART_sendByte(const uint8 data)
 {
 	while(!(UCSRA & (1<<UDRE)));
 
-	UDR = data ;
+	UART_writeFrame(data);
 }
 
 /* Inputs:
@@ -121,6 +149,26 @@ uint8 UART_receiveByte(void)
 	return UDR ;
 }
 
+/* Inputs:
+ * 	1. Pointer to the variable to be filled with the received byte.
+ *
+ * Return Value: TRUE if a byte was received, FALSE if no byte is waiting.
+ *
+ * Description:
+ *	Read the received byte without blocking, it is used by the event loops.
+ */
+boolean UART_receiveByteNonBlocking(uint8 *data)
+{
+	if(BIT_IS_CLEAR(UCSRA,RXC))
+	{
+		return FALSE ;
+	}
+
+	*data = UDR ;
+
+	return TRUE ;
+}
+
 /* Inputs:
  *
  * Return Value: void.
@@ -138,6 +186,91 @@ void UART_sendString(const uint8 *Str)
 	}
 }
 
+/* Inputs:
+ * 	1. data: The 9-bit frame, UART_ADDRESS_FLAG marks an address frame.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Send one frame in the 9-bit data mode, the 9th bit is written to TXB8 before UDR.
+ */
+void UART_sendNineBit(uint16 data)
+{
+	while(!(UCSRA & (1<<UDRE)));
+
+	if(data & UART_ADDRESS_FLAG)
+	{
+		SET_BIT(UCSRB,TXB8);
+	}
+	else
+	{
+		CLEAR_BIT(UCSRB,TXB8);
+	}
+
+	UART_writeFrame((uint8)data);
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The received 9-bit frame, UART_ADDRESS_FLAG is set for an address frame.
+ *
+ * Description:
+ *	Wait for one frame in the 9-bit data mode, the 9th bit is read from RXB8 before UDR.
+ */
+uint16 UART_receiveNineBit(void)
+{
+	uint16 data ;
+
+	while(!(UCSRA & (1<<RXC)));
+
+	/* RXB8 belongs to the frame at the top of the receive buffer, it must be read first */
+	data = (UCSRB & (1<<RXB8)) ? UART_ADDRESS_FLAG : 0 ;
+
+	return (data | UDR) ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the variable to be filled with the received 9-bit frame.
+ *
+ * Return Value: TRUE if a frame was received, FALSE if no frame is waiting.
+ *
+ * Description:
+ *	Read the received 9-bit frame without blocking.
+ */
+boolean UART_receiveNineBitNonBlocking(uint16 *data)
+{
+	if(BIT_IS_CLEAR(UCSRA,RXC))
+	{
+		return FALSE ;
+	}
+
+	*data = UART_receiveNineBit() ;
+
+	return TRUE ;
+}
+
+/* Inputs:
+ * 	1. enable: TRUE to receive the address frames only, FALSE to receive all the frames.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Enable or disable the multi-processor communication mode (MPCM) address filter.
+ *	A node waits for its address with the filter enabled then disables it to receive its data.
+ */
+void UART_setAddressFilter(boolean enable)
+{
+	/* Keep U2X only, the status flags (FE, DOR and PE) must be written with zero */
+	if(enable)
+	{
+		UCSRA = ( UCSRA & (1<<U2X) ) | (1<<MPCM) ;
+	}
+	else
+	{
+		UCSRA = ( UCSRA & (1<<U2X) ) ;
+	}
+}
+
 /* Inputs:
  *
  * Return Value: void.
@@ -159,3 +292,23 @@ void UART_receiveString(uint8 *Str)
 
 	Str[index] = '\0' ;
 }
+
+static void UART_writeFrame(uint8 data)
+{
+#if(UART_RS485_ENABLE == TRUE)
+	uint8 sreg ;
+
+	/*
+	 * The TXC flag of the last frame is cleared with the interrupts disabled, so its interrupt
+	 * does not release the driver after it is enabled for this frame.
+	 */
+	sreg = SREG ;
+	cli();
+	GPIO_writePin(UART_RS485_DE_PORT_ID, UART_RS485_DE_PIN_ID, LOGIC_HIGH);
+	UCSRA = ( UCSRA & ((1<<U2X) | (1<<MPCM)) ) | (1<<TXC) ;
+	UDR = data ;
+	SREG = sreg ;
+#else
+	UDR = data ;
+#endif
+}
@@ -22,6 +22,22 @@
  * 								 Definitions								*
  ****************************************************************************/
 
+/*
+ * The 9th bit of a frame in the 9-bit data mode (TXB8/RXB8), it marks the address frames of the
+ * multi-processor communication mode. A node with the address filter enabled (MPCM) receives
+ * the address frames only, the data frames are dropped by the hardware and RXC is not set.
+ */
+#define UART_ADDRESS_FLAG					0x0100
+
+/*
+ * RS-485 transceiver driver enable (DE and /RE tied together) on PD6, the driver is enabled before
+ * every transmitted frame and released by the transmit complete interrupt after the stop bit of
+ * the last frame, so the bus is free for the other nodes. The receiver output (RO) needs a pull-up
+ * while it is disabled. Set to FALSE for a point-to-point link.
+ */
+#define UART_RS485_ENABLE					TRUE
+#define UART_RS485_DE_PORT_ID				PORTD_ID
+#define UART_RS485_DE_PIN_ID				PIN6_ID
 
 /****************************************************************************
  * 					          Types Declaration						        *
@@ -104,6 +120,16 @@ void UART_sendByte(const uint8 data);
  */
 uint8 UART_receiveByte(void);
 
+/* Inputs:
+ * 	1. Pointer to the variable to be filled with the received byte.
+ *
+ * Return Value: TRUE if a byte was received, FALSE if no byte is waiting.
+ *
+ * Description:
+ *	Read the received byte without blocking, it is used by the event loops.
+ */
+boolean UART_receiveByteNonBlocking(uint8 *data);
+
 /* Inputs:
  *
  * Return Value: void.
@@ -113,6 +139,46 @@ uint8 UART_receiveByte(void);
  */
 void UART_sendString(const uint8 *Str);
 
+/* Inputs:
+ * 	1. data: The 9-bit frame, UART_ADDRESS_FLAG marks an address frame.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Send one frame in the 9-bit data mode, the 9th bit is written to TXB8 before UDR.
+ */
+void UART_sendNineBit(uint16 data);
+
+/* Inputs: void.
+ *
+ * Return Value: The received 9-bit frame, UART_ADDRESS_FLAG is set for an address frame.
+ *
+ * Description:
+ *	Wait for one frame in the 9-bit data mode, the 9th bit is read from RXB8 before UDR.
+ */
+uint16 UART_receiveNineBit(void);
+
+/* Inputs:
+ * 	1. Pointer to the variable to be filled with the received 9-bit frame.
+ *
+ * Return Value: TRUE if a frame was received, FALSE if no frame is waiting.
+ *
+ * Description:
+ *	Read the received 9-bit frame without blocking.
+ */
+boolean UART_receiveNineBitNonBlocking(uint16 *data);
+
+/* Inputs:
+ * 	1. enable: TRUE to receive the address frames only, FALSE to receive all the frames.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Enable or disable the multi-processor communication mode (MPCM) address filter.
+ *	A node waits for its address with the filter enabled then disables it to receive its data.
+ */
+void UART_setAddressFilter(boolean enable);
+
 /* Inputs:
  *
  * Return Value: void.
@@ -10,9 +10,14 @@
 /****************************************************************************
  * 								  Includes								    *
  ****************************************************************************/
+#include <avr/interrupt.h>
 #include <util/delay.h>
 #include "buzzer.h"
-#include "external_eeprom.h"
+#include "log_store.h"
+#include "settings.h"
+#include "audit_log.h"
+#include "user_db.h"
+#include "twi.h"
 #include "dc_motor.h"
 #include "uart.h"
 #include "timer1.h"
@@ -26,30 +31,367 @@
 #define OPEN_DOOR_CMD 						0x11
 #define CHANGE_PASSWORD_CMD 				0x12
 
+/* The session commands carry the session token (high byte first) instead of the password */
+#define OPEN_DOOR_TOKEN_CMD 				0x13
+#define CHANGE_PASSWORD_TOKEN_CMD 			0x14
+#define SESSION_TOKEN_SIZE					2
+
+/*
+ * The HMI asks for the door status after its reset, the reply is the status frame then the remaining
+ * lock-out time of the door in seconds (0 without a lock-out). A door with a saved password starts
+ * on the main screen, not on the create one.
+ */
+#define DOOR_STATUS_CMD						0x15
+#define DOOR_NO_PASSWORD_STATUS				0x44
+#define DOOR_PASSWORD_STATUS				0x45
+
+/*
+ * The users commands of an admin session, the enroll header is the session token, the user id
+ * (high bytes first), the doors mask and the flags of the user, the remove header is the session
+ * token only. The header is followed by the PIN of the user in password frames. The reply is the
+ * result then the new session token, or the session rejection.
+ */
+#define USER_ENROLL_TOKEN_CMD				0x60
+#define USER_REMOVE_TOKEN_CMD				0x61
+#define USER_ENROLL_HEADER_SIZE				(SESSION_TOKEN_SIZE + 4)
+#define USER_UPDATED						0x62
+#define USER_NOT_UPDATED					0x63
+
+/* Every successful check is followed by the new session token (high byte first) */
 #define SUCCESSFUL_PASSWORD_CHECK   		0x20
 #define UNSUCCESSFUL_PASSWORD_CHECK   		0x19
 
+/* A wrong password that started the lock-out, it is followed by the lock-out time in seconds */
+#define LOCKED_OUT_PASSWORD_CHECK			0x17
+
+/* The session token is expired or wrong, the HMI sends the command again with the password */
+#define SESSION_REJECTED					0x18
+
+/* Incremental password frames, every typed digit is sent as ('0' + digit) then Enter ends the entry */
+#define PASSWORD_DIGIT_FRAME				0x30
+#define PASSWORD_ENTER_FRAME				0x0D
+#define PASSWORD_FRAME_IS_DIGIT(frame)		(((frame) >= PASSWORD_DIGIT_FRAME) && ((frame) <= (PASSWORD_DIGIT_FRAME+9)))
+
+/*
+ * Service tool address on the link, it is not a door so the HMI panels ignore its frames.
+ * The dump command is answered with the audit log stream (audit_log.h) to the tool address.
+ */
+#define SERVICE_TOOL_ID						0x7F
+#define AUDIT_DUMP_CMD						0x50
+
+/*
+ * Door phase events, they are sent to the HMI ECU to update the control screen. The jammed event
+ * is followed by the events of the next locking attempt, or by the lock-out of the door.
+ */
+#define DOOR_UNLOCKED_EVENT					0x40
+#define DOOR_LOCKING_EVENT					0x41
+#define DOOR_LOCKED_EVENT					0x42
+#define DOOR_JAMMED_EVENT					0x43
+
+/*
+ * Every frame on the link is preceded by the 9-bit address frame of its door (multi-processor
+ * communication mode), the received data frames belong to the last address.
+ */
+#define DOOR_ADDRESS_FRAME(id)				(UART_ADDRESS_FLAG | (id))
+#define FRAME_IS_DOOR_ADDRESS(frame)		(((frame) & UART_ADDRESS_FLAG) != 0)
+#define FRAME_DOOR_ID(frame)				((uint8)(frame))
+
+/*
+ * The HMI panels and the service tool share the RS-485 bus and this ECU is the bus master, a node
+ * transmits one frame (its address frame then one data frame) only after its poll frame. The doors
+ * and the service tool are polled in turn, every poll waits LINK_POLL_TIMEOUT_MS for the answer.
+ * The answering node releases the bus after its stop bit, half a bit after its frame is received,
+ * so this ECU waits LINK_TURNAROUND_US before it replies.
+ */
+#define LINK_POLL_FLAG						0x80
+#define LINK_POLL_FRAME(id)					(UART_ADDRESS_FLAG | LINK_POLL_FLAG | (id))
+#define LINK_POLL_TIMEOUT_MS				4
+#define LINK_TURNAROUND_US					60
+
+/*
+ * Number of doors serviced by this ECU, every door has its own HMI panel, motor and password.
+ * The doors motors are channels of the multi-channel motor driver, the single-channel driver
+ * (encoder position loop or interrupt limit switches) moves one door only. The board has one
+ * door, DC_MOTOR_MULTI_CHANNEL_ENABLE adds the second one on the DOOR1 pins.
+ */
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+#define NUM_OF_DOORS						2
+#else
+#define NUM_OF_DOORS						1
+#endif
+#define DOOR_NO_ID							0xFF
+
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+/*
+ * Second door motor channel, it shares the OC0 PWM with the first door (L293D pins of dc_motor.h).
+ * Its L293D inputs are PB4/PB5 and its open/closed limit switches are PD4/PD5, its panel is an HMI
+ * ECU built with HMI_DOOR_ID 1.
+ */
+#define DOOR1_IN1_PORT						PORTB_ID
+#define DOOR1_IN1_PIN						PIN4_ID
+#define DOOR1_IN2_PORT						PORTB_ID
+#define DOOR1_IN2_PIN						PIN5_ID
+#define DOOR1_CW_LIMIT_PORT					PORTD_ID
+#define DOOR1_CW_LIMIT_PIN					PIN4_ID
+#define DOOR1_ACW_LIMIT_PORT				PORTD_ID
+#define DOOR1_ACW_LIMIT_PIN					PIN5_ID
+#endif
+
+/*
+ * Every door keeps its password in the log store record of key (DOOR_PASSWORD_KEY + id).
+ * The fixed EEPROM area of the older firmware is read only while the door has no record.
+ */
+#define DOOR_PASSWORD_KEY					0
+#define DOOR_LEGACY_PASSWORD_ADDRESS(id)	(0x0311 + ((uint16)(id) * PASSWORD_SIZE))
+
+#if((DOOR_PASSWORD_KEY + NUM_OF_DOORS) > LOG_STORE_NUM_OF_KEYS)
+#error "The log store has no keys for all the doors passwords"
+#endif
+
+/*
+ * A door opened by its own password is opened by the master user, the other users have their own PINs.
+ * The master and the admin users may change the door password, the sessions of the other users open
+ * the door only.
+ */
+#define DOOR_MASTER_USER_ID					0
+
+#if(NUM_OF_DOORS > 8)
+#error "The users doors mask has no bits for all the doors"
+#endif
+
+#if((NUM_OF_DOORS + 4) > SETTINGS_DATA_SIZE)
+#error "The settings block has no room for the faults counters of all the doors"
+#endif
+
+/*
+ * Bit n of the saved passwords mask is set when door n has a password. A mask with bits of no door
+ * is from a block without the mask (a new board or the older firmware), it is rebuilt from the store.
+ */
+#define DOOR_ALL_DOORS_MASK					((uint8)((1 << NUM_OF_DOORS) - 1))
+#define DOOR_PASSWORDS_UNKNOWN				0xFF
+
+#if(NUM_OF_DOORS > 7)
+#error "The saved passwords mask has no spare bit to detect an older settings block"
+#endif
+
+/*
+ * The external EEPROM of the board, one 24C16. A 24C512 bank is EEPROM_TWO_ADDRESS_BYTES,
+ * 16 address bits, 128 bytes pages and up to 8 chips on the device-select pins.
+ */
+#define CONTROL_EEPROM_ADDRESSING			EEPROM_ONE_ADDRESS_BYTE
+#define CONTROL_EEPROM_CHIP_ADDRESS_BITS	11
+#define CONTROL_EEPROM_PAGE_SIZE			16
+#define CONTROL_EEPROM_NUM_OF_CHIPS			1
+
+/*
+ * Timer1 ticks the doors timers every 100ms: F_CPU/1024 and compare value 781 at 8MHz.
+ * The unlocked hold time and the lock-out alarm time are in ticks.
+ */
+#define CONTROL_TICK_COMPARE_VALUE			781
+#define CONTROL_TICKS_PER_SECOND			10
+
+/*
+ * Defaults of the settings block, they are used until the first commit.
+ * Time in seconds to keep the door unlocked, the unlocking/locking phases end on the limit switches.
+ */
+#define DOOR_HOLD_TIME						3
+
+/* Wrong passwords in a row before the lock-out alarm of the door and the alarm time in seconds */
+#define DOOR_MAX_FAULTS						3
+#define DOOR_ALARM_TIME						60
+
+/*
+ * A session is opened by every successful password check and it expires SESSION_TIMEOUT seconds
+ * after that check, the token uses do not extend it. Its token is used once, every accepted token
+ * is replaced by a new one and a session accepts SESSION_MAX_USES tokens at most.
+ */
+#define SESSION_TIMEOUT						60
+#define SESSION_MAX_USES					3
+#define SESSION_NO_TOKEN					0
+
+/* Motion profile used to move the door, the motor soft-starts and soft-stops inside every phase */
+#define DOOR_MOTOR_PROFILE					DC_MOTOR_PROFILE_DOOR
+
+/*
+ * A door that stalls while it moves is locked again, up to DOOR_LOCK_RETRIES times. A door that
+ * can not be locked starts the lock-out alarm and it is locked again when the alarm ends.
+ */
+#define DOOR_LOCK_RETRIES					2
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+typedef enum
+{
+	DOOR_IDLE,
+
+	/* Receiving the password digits of a command */
+	DOOR_RECEIVING,
+
+	/* Receiving the session token of a session command */
+	DOOR_RECEIVING_TOKEN,
+
+	/* Receiving the header of a users command */
+	DOOR_RECEIVING_USER,
+
+	/* Waiting for the shared motor PWM to unlock/lock the door */
+	DOOR_WAIT_UNLOCK,
+	DOOR_UNLOCKING,
+	DOOR_UNLOCKED,
+	DOOR_WAIT_LOCK,
+	DOOR_LOCKING,
+
+	/* Lock-out after max_faults wrong passwords, the frames of the door are ignored */
+	DOOR_ALARM
+
+}Door_State;
+
+typedef struct
+{
+	uint8 id ;
+
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+	/* Motor direction pins and limit switches of the door */
+	const DcMotor_PinsType *motor ;
+#endif
+
+	/* The typed password is compared with the reference digit by digit */
+	uint8 reference[PASSWORD_SIZE] ;
+	uint8 entry[PASSWORD_SIZE] ;
+	boolean check_reference ;
+	uint8 index ;
+	uint8 check_status ;
+
+	/* The running command and its entry number (a new password is typed twice) */
+	uint8 command ;
+	uint8 entry_number ;
+
+	uint8 count_faults ;
+
+	/* Locking attempts left after a stall, the jammed door is locked again without the HMI events */
+	uint8 lock_retries ;
+	boolean jammed ;
+
+	/* The user of the last successful open command and its flags */
+	uint16 user_id ;
+	uint8 user_flags ;
+
+	/*
+	 * A successful change check allows the next password create of a door with a saved password,
+	 * until the create or the end of the session of the check.
+	 */
+	boolean change_allowed ;
+
+	/* The session token is valid while the session timer is running, the received token is compared with it */
+	uint16 session_token ;
+	uint16 session_timer ;
+	uint8 session_uses ;
+
+	/* The user who opened the session by the password check and its flags */
+	uint16 session_user ;
+	uint8 session_flags ;
+	uint16 received_token ;
+
+	/* The user of a users command, the PIN is the password entry */
+	UserDb_UserType pending_user ;
+
+	Door_State state ;
+
+	/* Remaining time of the hold and the alarm states in ticks */
+	uint16 timer ;
+
+}DoorContext;
+
+/* The settings block, it is committed to the inactive A/B slot on every change */
+typedef struct
+{
+	/* Wrong passwords in a row of every door, so a reset does not clear a lock-out */
+	uint8 count_faults[NUM_OF_DOORS] ;
+
+	uint8 hold_time ;
+	uint8 alarm_time ;
+	uint8 max_faults ;
+
+	/* Doors with a saved password, so the boot does not read the passwords to find them */
+	uint8 password_doors ;
+
+}ControlSettings;
+
 /****************************************************************************
  * 							   Global Variables								*
  ****************************************************************************/
-uint8 password[PASSWORD_SIZE];
-uint8 password_check[PASSWORD_SIZE];
 
-uint8 g_counter;
-uint8 g_command;
-uint8 g_check_status;
-uint8 g_count_faults;
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+/* Motor channels of the doors, they are attached to the motor driver before every move */
+const DcMotor_PinsType g_doorMotors[NUM_OF_DOORS] =
+{
+	{ L293D_IN1_PORT, L293D_IN1_PIN, L293D_IN2_PORT, L293D_IN2_PIN,
+	  DC_MOTOR_CW_LIMIT_PORT_ID, DC_MOTOR_CW_LIMIT_PIN_ID, DC_MOTOR_ACW_LIMIT_PORT_ID, DC_MOTOR_ACW_LIMIT_PIN_ID },
+	{ DOOR1_IN1_PORT, DOOR1_IN1_PIN, DOOR1_IN2_PORT, DOOR1_IN2_PIN,
+	  DOOR1_CW_LIMIT_PORT, DOOR1_CW_LIMIT_PIN, DOOR1_ACW_LIMIT_PORT, DOOR1_ACW_LIMIT_PIN }
+};
+#endif
+
+DoorContext g_doors[NUM_OF_DOORS];
+
+ControlSettings g_settings ;
+
+/* Door (or the service tool) addressed by the last received address frame */
+uint8 g_linkDoor = DOOR_NO_ID ;
+
+/* Door (or the service tool) polled now, it is answered by one data frame */
+uint8 g_pollId = SERVICE_TOOL_ID ;
+boolean g_pollAnswered = FALSE ;
+
+/* Door moved by the motor now and the last door that got the motor (round-robin) */
+uint8 g_motorDoor = DOOR_NO_ID ;
+uint8 g_lastMotorDoor = 0 ;
+
+volatile uint8 g_counter;
+
+/* Ticks towards the next second of the audit log clock */
+uint8 g_secondTicks = 0 ;
+
+/* Rolling nonce of the session tokens, it is never zero */
+uint16 g_nonce = 1 ;
 
 /****************************************************************************
  * 							Functions Prototypes						    *
  ****************************************************************************/
-void Control_ECU_fetchCommand(void);
-void Control_ECU_receivePassword(uint8 *password_buffer,uint8 size);
-void Control_ECU_checkPassword(uint8 *password_buffer_1,uint8 *password_buffer_2,uint8 size);
-void Control_ECU_writePassword(uint8 *password_buffer,uint8 size);
-void Control_ECU_checkSavedPassword(uint8 *password_buffer_1,uint8 *password_buffer_2,uint8 size);
-void Control_ECU_controllingDcMotorConfig(void);
-void Control_ECU_activateBuzzerConfig(void);
+void Control_ECU_initDoors(void);
+void Control_ECU_pollLink(void);
+void Control_ECU_serviceLink(void);
+void Control_ECU_serviceMotor(void);
+void Control_ECU_serviceTimers(uint8 ticks);
+void Control_ECU_doorFrame(DoorContext *door,uint8 frame);
+void Control_ECU_startEntry(DoorContext *door,boolean check_reference);
+void Control_ECU_receivePassword(DoorContext *door,uint8 frame);
+void Control_ECU_entryDone(DoorContext *door);
+void Control_ECU_countFault(DoorContext *door);
+void Control_ECU_setFaults(DoorContext *door,uint8 count_faults);
+void Control_ECU_startAlarm(DoorContext *door);
+void Control_ECU_setPasswordSaved(const DoorContext *door);
+void Control_ECU_loadSettings(void);
+boolean Control_ECU_hasSavedPassword(DoorContext *door);
+void Control_ECU_sendStatus(DoorContext *door);
+void Control_ECU_receiveToken(DoorContext *door,uint8 frame);
+boolean Control_ECU_tokenValid(const DoorContext *door,boolean admin);
+void Control_ECU_receiveUser(DoorContext *door,uint8 frame);
+void Control_ECU_updateUser(DoorContext *door);
+void Control_ECU_renewToken(DoorContext *door);
+void Control_ECU_openSession(DoorContext *door);
+void Control_ECU_closeSession(DoorContext *door);
+uint16 Control_ECU_nextNonce(void);
+void Control_ECU_writePassword(const DoorContext *door);
+void Control_ECU_readSavedPassword(DoorContext *door);
+void Control_ECU_replyCheckStatus(DoorContext *door);
+void Control_ECU_startMove(DoorContext *door);
+void Control_ECU_moveDone(DoorContext *door);
+void Control_ECU_sendFrame(const DoorContext *door,uint8 frame);
+void Control_ECU_serviceToolFrame(uint8 frame);
+void Control_ECU_sendServiceByte(uint8 data);
+void Control_ECU_playBuzzer(uint8 pattern_id);
+boolean Control_ECU_alarmActive(void);
 void Control_ECU_callBackFunction(void);
 
 
@@ -58,179 +400,896 @@ void Control_ECU_callBackFunction(void);
  ****************************************************************************/
 int main()
 {
+	uint8 last_counter = 0 ;
+	uint8 counter ;
+
 	sei();
 
 	DcMotor_Init();
 
 	Buzzer_init();
 
+	Control_ECU_initDoors();
+
+	TWI_ConfigType TWI_ConfigStruct ;
+	TWI_ConfigStruct.address = 0x01 ;
+	TWI_ConfigStruct.bit_rate = Fast_Mode ;
+	TWI_init(&TWI_ConfigStruct);
+
+	EEPROM_ConfigType EEPROM_ConfigStruct ;
+	EEPROM_ConfigStruct.addressing = CONTROL_EEPROM_ADDRESSING ;
+	EEPROM_ConfigStruct.chip_address_bits = CONTROL_EEPROM_CHIP_ADDRESS_BITS ;
+	EEPROM_ConfigStruct.page_size = CONTROL_EEPROM_PAGE_SIZE ;
+	EEPROM_ConfigStruct.num_of_chips = CONTROL_EEPROM_NUM_OF_CHIPS ;
+	EEPROM_init(&EEPROM_ConfigStruct);
+
+	LogStore_init();
+
+	UserDb_init();
+
+	AuditLog_init();
+	AuditLog_log(AUDIT_EVENT_BOOT, 0, AUDIT_LOG_NO_USER, TRUE);
+
+	Control_ECU_loadSettings();
+
 	UART_ConfigType UART_ConfigStruct ;
 	UART_ConfigStruct.baud_rate = 19200 ;
-	UART_ConfigStruct.bit_data = Eight_Bit_Data ;
+	UART_ConfigStruct.bit_data = Nine_Bit_Data ;
 	UART_ConfigStruct.parity = Disable_Parity ;
 	UART_ConfigStruct.stop_bit = One_Bit_Stop ;
 	UART_init(&UART_ConfigStruct);
 
+	/* The doors timers tick always, the event loop counts the ticks since its last pass */
+	Timer1_setCallBack(Control_ECU_callBackFunction);
+	Timer1_ConfigType Timer1_ConfigStruct;
+	Timer1_ConfigStruct.mode = Timer1_Compare_Mode ;
+	Timer1_ConfigStruct.prescaler = F_CPU_1024 ;
+	Timer1_ConfigStruct.initial_value = 0 ;
+	Timer1_ConfigStruct.compare_value = CONTROL_TICK_COMPARE_VALUE ;
+	Timer1_init(&Timer1_ConfigStruct);
+
 	while(1)
 	{
-		Control_ECU_fetchCommand();
+		Control_ECU_pollLink();
+		Control_ECU_serviceMotor();
+		LogStore_service();
+		AuditLog_service();
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+		EEPROM_service();
+#endif
+
+		counter = g_counter ;
+		if(counter != last_counter)
+		{
+			Control_ECU_serviceTimers((uint8)(counter - last_counter));
+			last_counter = counter ;
+		}
 	}
 
 	return 0 ;
 }
 
-void Control_ECU_fetchCommand(void)
+void Control_ECU_initDoors(void)
+{
+	uint8 id ;
+
+	for(id = 0 ; id < NUM_OF_DOORS ; id++)
+	{
+		g_doors[id].id = id ;
+		g_doors[id].count_faults = 0 ;
+		g_doors[id].session_token = SESSION_NO_TOKEN ;
+		g_doors[id].session_timer = 0 ;
+		g_doors[id].change_allowed = FALSE ;
+		g_doors[id].lock_retries = DOOR_LOCK_RETRIES ;
+		g_doors[id].jammed = FALSE ;
+		g_doors[id].state = DOOR_IDLE ;
+
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+		/* Setup the pins of every motor, they stay stopped until the door moves */
+		g_doors[id].motor = &g_doorMotors[id] ;
+		DcMotor_attach(g_doors[id].motor);
+#endif
+	}
+}
+
+/*
+ * Poll the next door (or the service tool) and dispatch its answer, the bus is quiet after the
+ * answer or the timeout so this ECU may send its replies and events.
+ */
+void Control_ECU_pollLink(void)
+{
+	uint8 timeout ;
+
+	if(g_pollId == SERVICE_TOOL_ID)
+	{
+		g_pollId = 0 ;
+	}
+	else if((g_pollId + 1) < NUM_OF_DOORS)
+	{
+		g_pollId++ ;
+	}
+	else
+	{
+		g_pollId = SERVICE_TOOL_ID ;
+	}
+
+	g_pollAnswered = FALSE ;
+	UART_sendNineBit(LINK_POLL_FRAME(g_pollId));
+
+	for(timeout = 0 ; timeout < LINK_POLL_TIMEOUT_MS ; timeout++)
+	{
+		Control_ECU_serviceLink();
+		if(g_pollAnswered)
+		{
+			return ;
+		}
+		_delay_ms(1);
+	}
+}
+
+/*
+ * Dispatch the received frames to the door of the last address frame without blocking,
+ * the frames of an unknown door are dropped.
+ */
+void Control_ECU_serviceLink(void)
+{
+	uint16 frame ;
+
+	while(UART_receiveNineBitNonBlocking(&frame))
+	{
+		if(FRAME_IS_DOOR_ADDRESS(frame))
+		{
+			g_linkDoor = ((FRAME_DOOR_ID(frame) < NUM_OF_DOORS) || (FRAME_DOOR_ID(frame) == SERVICE_TOOL_ID)) ? FRAME_DOOR_ID(frame) : DOOR_NO_ID ;
+		}
+		else if(g_linkDoor != DOOR_NO_ID)
+		{
+			if(g_linkDoor == g_pollId)
+			{
+				g_pollAnswered = TRUE ;
+			}
+
+			/* A reply must not start before the answering node releases the bus */
+			_delay_us(LINK_TURNAROUND_US);
+
+			if(g_linkDoor == SERVICE_TOOL_ID)
+			{
+				Control_ECU_serviceToolFrame((uint8)frame);
+			}
+			else
+			{
+				Control_ECU_doorFrame(&g_doors[g_linkDoor], (uint8)frame);
+			}
+		}
+	}
+}
+
+/*
+ * The doors share the motor PWM, so one door moves at a time. The door that finished its move
+ * is reported then the waiting doors get the motor in round-robin order.
+ */
+void Control_ECU_serviceMotor(void)
+{
+	uint8 count ;
+	uint8 id ;
+
+	if(g_motorDoor != DOOR_NO_ID)
+	{
+		if(DcMotor_isMoving())
+		{
+			return ;
+		}
+		id = g_motorDoor ;
+		g_motorDoor = DOOR_NO_ID ;
+		Control_ECU_moveDone(&g_doors[id]);
+	}
+
+	id = g_lastMotorDoor ;
+	for(count = 0 ; count < NUM_OF_DOORS ; count++)
+	{
+		id = ((id + 1) < NUM_OF_DOORS) ? (id + 1) : 0 ;
+		if((g_doors[id].state == DOOR_WAIT_UNLOCK) || (g_doors[id].state == DOOR_WAIT_LOCK))
+		{
+			g_lastMotorDoor = id ;
+			g_motorDoor = id ;
+			Control_ECU_startMove(&g_doors[id]);
+			return ;
+		}
+	}
+}
+
+void Control_ECU_serviceTimers(uint8 ticks)
 {
-	g_command = UART_receiveByte();
-	switch(g_command)
+	uint8 id ;
+	DoorContext *door ;
+
+	g_secondTicks += ticks ;
+	while(g_secondTicks >= CONTROL_TICKS_PER_SECOND)
+	{
+		g_secondTicks -= CONTROL_TICKS_PER_SECOND ;
+		AuditLog_tick();
+	}
+
+	for(id = 0 ; id < NUM_OF_DOORS ; id++)
+	{
+		door = &g_doors[id] ;
+
+		if(door->session_timer != 0)
+		{
+			door->session_timer = (door->session_timer > ticks) ? (door->session_timer - ticks) : 0 ;
+			if(door->session_timer == 0)
+			{
+				Control_ECU_closeSession(door);
+			}
+		}
+
+		if((door->state != DOOR_UNLOCKED) && (door->state != DOOR_ALARM))
+		{
+			continue ;
+		}
+
+		door->timer = (door->timer > ticks) ? (door->timer - ticks) : 0 ;
+		if(door->timer != 0)
+		{
+			continue ;
+		}
+
+		if(door->state == DOOR_UNLOCKED)
+		{
+			door->state = DOOR_WAIT_LOCK ;
+		}
+		else
+		{
+			/* The lock-out of a jammed door ends by another locking attempt */
+			door->state = door->jammed ? DOOR_WAIT_LOCK : DOOR_IDLE ;
+			Control_ECU_setFaults(door, 0);
+			if(!Control_ECU_alarmActive())
+			{
+				Buzzer_stop();
+			}
+		}
+	}
+}
+
+void Control_ECU_doorFrame(DoorContext *door,uint8 frame)
+{
+	/*
+	 * A status request comes from a reset HMI, an entry it started before the reset is dropped.
+	 * A token or user byte may have the same value, so it is not a request while a header is received.
+	 */
+	if((frame == DOOR_STATUS_CMD) && (door->state != DOOR_RECEIVING_TOKEN) && (door->state != DOOR_RECEIVING_USER))
+	{
+		if(door->state == DOOR_RECEIVING)
+		{
+			door->state = DOOR_IDLE ;
+		}
+		Control_ECU_sendStatus(door);
+		return ;
+	}
+
+	switch(door->state)
+	{
+	case DOOR_IDLE :
+		door->command = frame ;
+		door->entry_number = 0 ;
+		switch(frame)
+		{
+		case CREATE_PASSWORD_CMD :
+			/* The first entry is only stored, the second one is compared with it while it is typed */
+			Control_ECU_startEntry(door, FALSE);
+			break;
+		case OPEN_DOOR_CMD :
+		case CHANGE_PASSWORD_CMD :
+			/* Prefetch the saved password while the user is still typing */
+			Control_ECU_readSavedPassword(door);
+			Control_ECU_startEntry(door, TRUE);
+			break;
+		case OPEN_DOOR_TOKEN_CMD :
+		case CHANGE_PASSWORD_TOKEN_CMD :
+			door->index = 0 ;
+			door->received_token = 0 ;
+			door->state = DOOR_RECEIVING_TOKEN ;
+			break;
+		case USER_ENROLL_TOKEN_CMD :
+		case USER_REMOVE_TOKEN_CMD :
+			door->index = 0 ;
+			door->received_token = 0 ;
+			door->pending_user.user_id = 0 ;
+			door->state = DOOR_RECEIVING_USER ;
+			break;
+		}
+		break;
+	case DOOR_RECEIVING :
+		Control_ECU_receivePassword(door, frame);
+		break;
+	case DOOR_RECEIVING_TOKEN :
+		Control_ECU_receiveToken(door, frame);
+		break;
+	case DOOR_RECEIVING_USER :
+		Control_ECU_receiveUser(door, frame);
+		break;
+	default :
+		/* The door is moving or locked-out */
+		break;
+	}
+}
+
+void Control_ECU_startEntry(DoorContext *door,boolean check_reference)
+{
+	door->check_reference = check_reference ;
+	door->index = 0 ;
+	door->check_status = SUCCESSFUL_PASSWORD_CHECK ;
+	door->state = DOOR_RECEIVING ;
+}
+
+/*
+ * Every digit frame is compared with the reference (if any) as soon as it arrives,
+ * so the check status is ready when the Enter frame arrives.
+ */
+void Control_ECU_receivePassword(DoorContext *door,uint8 frame)
+{
+	if(PASSWORD_FRAME_IS_DIGIT(frame))
+	{
+		Control_ECU_playBuzzer(BUZZER_PATTERN_KEY_CLICK);
+		if(door->index < PASSWORD_SIZE)
+		{
+			door->entry[door->index] = (frame - PASSWORD_DIGIT_FRAME) ;
+			if(door->check_reference && (door->entry[door->index] != door->reference[door->index]))
+			{
+				door->check_status = UNSUCCESSFUL_PASSWORD_CHECK ;
+			}
+		}
+		if(door->index < 0xFF)
+		{
+			door->index++ ;
+		}
+	}
+	else if(frame == PASSWORD_ENTER_FRAME)
+	{
+		if(door->index != PASSWORD_SIZE)
+		{
+			door->check_status = UNSUCCESSFUL_PASSWORD_CHECK ;
+		}
+		Control_ECU_entryDone(door);
+	}
+}
+
+void Control_ECU_entryDone(DoorContext *door)
+{
+	UserDb_UserType user ;
+	uint8 index ;
+
+	switch(door->command)
 	{
 	case CREATE_PASSWORD_CMD :
-		Control_ECU_receivePassword(password,PASSWORD_SIZE);
-		Control_ECU_receivePassword(password_check,PASSWORD_SIZE);
-		Control_ECU_checkPassword(password, password_check, PASSWORD_SIZE);
-		if(g_check_status == SUCCESSFUL_PASSWORD_CHECK)
+		if(door->entry_number == 0)
+		{
+			for(index = 0 ; index < PASSWORD_SIZE ; index++)
+			{
+				door->reference[index] = door->entry[index] ;
+			}
+			door->entry_number = 1 ;
+			Control_ECU_startEntry(door, TRUE);
+			return ;
+		}
+		/* A saved password is replaced only after a successful change check */
+		if(BIT_IS_SET(g_settings.password_doors, door->id) && !door->change_allowed)
 		{
-			Control_ECU_writePassword(password, PASSWORD_SIZE);
+			door->check_status = UNSUCCESSFUL_PASSWORD_CHECK ;
+		}
+		Control_ECU_replyCheckStatus(door);
+		AuditLog_log(AUDIT_EVENT_PASSWORD_CREATE, door->id, DOOR_MASTER_USER_ID, (door->check_status == SUCCESSFUL_PASSWORD_CHECK));
+		door->state = DOOR_IDLE ;
+		if(door->check_status == SUCCESSFUL_PASSWORD_CHECK)
+		{
+			door->change_allowed = FALSE ;
+			Control_ECU_writePassword(door);
+			Control_ECU_setPasswordSaved(door);
 		}
 		break;
 	case OPEN_DOOR_CMD :
-		Control_ECU_receivePassword(password,PASSWORD_SIZE);
-		Control_ECU_checkSavedPassword(password, password_check, PASSWORD_SIZE);
-		if(g_check_status == SUCCESSFUL_PASSWORD_CHECK)
+		/* A session command keeps the user of its session */
+		if(door->state == DOOR_RECEIVING)
 		{
-			g_count_faults = 0 ;
-			Control_ECU_controllingDcMotorConfig();
+			door->user_id = DOOR_MASTER_USER_ID ;
+			door->user_flags = USER_DB_FLAG_ADMIN ;
+			if((door->check_status == UNSUCCESSFUL_PASSWORD_CHECK) && (door->index == PASSWORD_SIZE))
+			{
+				/* Not the door password, it may be the PIN of a user allowed to open this door */
+				if((UserDb_find(door->entry, PASSWORD_SIZE, &user) == SUCCESS) && BIT_IS_SET(user.doors, door->id))
+				{
+					door->user_id = user.user_id ;
+					door->user_flags = user.flags ;
+					door->check_status = SUCCESSFUL_PASSWORD_CHECK ;
+				}
+			}
 		}
 		else
 		{
-			g_count_faults += 1 ;
+			door->user_id = door->session_user ;
+			door->user_flags = door->session_flags ;
+		}
+		Control_ECU_replyCheckStatus(door);
+		AuditLog_log(AUDIT_EVENT_DOOR_OPEN, door->id,
+				((door->check_status == SUCCESSFUL_PASSWORD_CHECK) ? door->user_id : AUDIT_LOG_NO_USER),
+				(door->check_status == SUCCESSFUL_PASSWORD_CHECK));
+		door->state = DOOR_IDLE ;
+		if(door->check_status == SUCCESSFUL_PASSWORD_CHECK)
+		{
+			Control_ECU_setFaults(door, 0);
+			door->state = DOOR_WAIT_UNLOCK ;
 		}
-		if(g_count_faults == 3)
+		else
 		{
-			Control_ECU_activateBuzzerConfig();
-			g_count_faults = 0 ;
+			Control_ECU_countFault(door);
 		}
 		break;
 	case CHANGE_PASSWORD_CMD :
-		Control_ECU_receivePassword(password,PASSWORD_SIZE);
-		Control_ECU_checkSavedPassword(password, password_check, PASSWORD_SIZE);
-		if(g_check_status == SUCCESSFUL_PASSWORD_CHECK)
+		Control_ECU_replyCheckStatus(door);
+		AuditLog_log(AUDIT_EVENT_PASSWORD_CHECK, door->id,
+				((door->check_status == SUCCESSFUL_PASSWORD_CHECK) ? DOOR_MASTER_USER_ID : AUDIT_LOG_NO_USER),
+				(door->check_status == SUCCESSFUL_PASSWORD_CHECK));
+		door->state = DOOR_IDLE ;
+		door->change_allowed = (door->check_status == SUCCESSFUL_PASSWORD_CHECK) ;
+		if(door->check_status == SUCCESSFUL_PASSWORD_CHECK)
 		{
-			g_count_faults = 0 ;
-			Control_ECU_writePassword(password, PASSWORD_SIZE);
+			Control_ECU_setFaults(door, 0);
 		}
 		else
 		{
-			g_count_faults += 1 ;
+			Control_ECU_countFault(door);
+		}
+		break;
+	case USER_ENROLL_TOKEN_CMD :
+	case USER_REMOVE_TOKEN_CMD :
+		Control_ECU_updateUser(door);
+		break;
+	default :
+		door->state = DOOR_IDLE ;
+		break;
+	}
+}
+
+void Control_ECU_countFault(DoorContext *door)
+{
+	Control_ECU_setFaults(door, (door->count_faults + 1));
+	if(door->count_faults >= g_settings.max_faults)
+	{
+		Control_ECU_startAlarm(door);
+	}
+}
+
+/*
+ * The faults counter is committed only when it changes, a successful check with no
+ * faults before it does not write the EEPROM.
+ */
+void Control_ECU_setFaults(DoorContext *door,uint8 count_faults)
+{
+	door->count_faults = count_faults ;
+	if(g_settings.count_faults[door->id] != count_faults)
+	{
+		g_settings.count_faults[door->id] = count_faults ;
+		Settings_commit((const uint8*)&g_settings, sizeof(ControlSettings));
+	}
+}
+
+/*
+ * The faults counter stays at the limit until the alarm ends, so a reset during the
+ * lock-out starts it again.
+ */
+void Control_ECU_startAlarm(DoorContext *door)
+{
+	/* The alarm is played by the Timer2 interrupt, the door only waits for the lock-out time */
+	door->timer = ((uint16)g_settings.alarm_time * CONTROL_TICKS_PER_SECOND) ;
+	door->state = DOOR_ALARM ;
+	Buzzer_play(BUZZER_PATTERN_ALARM);
+	AuditLog_log(AUDIT_EVENT_LOCKOUT, door->id, AUDIT_LOG_NO_USER, TRUE);
+}
+
+void Control_ECU_setPasswordSaved(const DoorContext *door)
+{
+	if(!BIT_IS_SET(g_settings.password_doors, door->id))
+	{
+		SET_BIT(g_settings.password_doors, door->id);
+		Settings_commit((const uint8*)&g_settings, sizeof(ControlSettings));
+	}
+}
+
+/*
+ * The settings block is the runtime state snapshot, the faults counters and the saved passwords
+ * mask are restored by reading it once. The passwords are read only to rebuild a missing mask.
+ */
+void Control_ECU_loadSettings(void)
+{
+	uint8 id ;
+
+	/* The defaults of a new board, they are kept if no slot is valid */
+	for(id = 0 ; id < NUM_OF_DOORS ; id++)
+	{
+		g_settings.count_faults[id] = 0 ;
+	}
+	g_settings.hold_time = DOOR_HOLD_TIME ;
+	g_settings.alarm_time = DOOR_ALARM_TIME ;
+	g_settings.max_faults = DOOR_MAX_FAULTS ;
+	g_settings.password_doors = DOOR_PASSWORDS_UNKNOWN ;
+	Settings_load((uint8*)&g_settings, sizeof(ControlSettings));
+
+	if((g_settings.password_doors & (uint8)(~DOOR_ALL_DOORS_MASK)) != 0)
+	{
+		g_settings.password_doors = 0 ;
+		for(id = 0 ; id < NUM_OF_DOORS ; id++)
+		{
+			if(Control_ECU_hasSavedPassword(&g_doors[id]))
+			{
+				SET_BIT(g_settings.password_doors, id);
+			}
 		}
-		if(g_count_faults == 3)
+		Settings_commit((const uint8*)&g_settings, sizeof(ControlSettings));
+	}
+
+	for(id = 0 ; id < NUM_OF_DOORS ; id++)
+	{
+		g_doors[id].count_faults = g_settings.count_faults[id] ;
+		if(g_doors[id].count_faults >= g_settings.max_faults)
 		{
-			Control_ECU_activateBuzzerConfig();
-			g_count_faults = 0 ;
+			Control_ECU_startAlarm(&g_doors[id]);
 		}
-		break;
 	}
 }
 
-void Control_ECU_receivePassword(uint8 *password_buffer,uint8 size)
+/*
+ * The password is in the log store or in the legacy area, an erased area does not hold digits.
+ */
+boolean Control_ECU_hasSavedPassword(DoorContext *door)
 {
 	uint8 index ;
-	for(index = 0 ; index < size ; index++)
+
+	Control_ECU_readSavedPassword(door);
+	for(index = 0 ; index < PASSWORD_SIZE ; index++)
 	{
-		password_buffer[index] = UART_receiveByte();
+		if(door->reference[index] > 9)
+		{
+			return FALSE ;
+		}
 	}
+
+	return TRUE ;
 }
 
-void Control_ECU_checkPassword(uint8 *password_buffer_1,uint8 *password_buffer_2,uint8 size)
+void Control_ECU_sendStatus(DoorContext *door)
 {
-	g_check_status = SUCCESSFUL_PASSWORD_CHECK ;
-	uint8 index ;
-	for(index = 0 ; index < size ; index++)
+	Control_ECU_sendFrame(door, (BIT_IS_SET(g_settings.password_doors, door->id) ? DOOR_PASSWORD_STATUS : DOOR_NO_PASSWORD_STATUS));
+	Control_ECU_sendFrame(door, ((door->state == DOOR_ALARM) ? (uint8)((door->timer + CONTROL_TICKS_PER_SECOND - 1) / CONTROL_TICKS_PER_SECOND) : 0));
+}
+
+/*
+ * The session token is checked by a RAM compare, an accepted token runs the command like a
+ * correct password. A wrong token closes the session, so it can be guessed once per session.
+ */
+void Control_ECU_receiveToken(DoorContext *door,uint8 frame)
+{
+	door->received_token = (door->received_token << 8) | frame ;
+	door->index++ ;
+	if(door->index < SESSION_TOKEN_SIZE)
 	{
-		if(password_buffer_1[index] != password_buffer_2[index])
+		return ;
+	}
+
+	/* The session of a user PIN without the admin flag does not reach the password change */
+	if(!Control_ECU_tokenValid(door, (door->command == CHANGE_PASSWORD_TOKEN_CMD)))
+	{
+		Control_ECU_closeSession(door);
+		door->state = DOOR_IDLE ;
+		Control_ECU_sendFrame(door, SESSION_REJECTED);
+		return ;
+	}
+
+	door->command = (door->command == OPEN_DOOR_TOKEN_CMD) ? OPEN_DOOR_CMD : CHANGE_PASSWORD_CMD ;
+	door->check_status = SUCCESSFUL_PASSWORD_CHECK ;
+	Control_ECU_entryDone(door);
+}
+
+/*
+ * A token is accepted once while its session is open, the admin commands need the session of an admin.
+ */
+boolean Control_ECU_tokenValid(const DoorContext *door,boolean admin)
+{
+	return ((door->session_token != SESSION_NO_TOKEN) && (door->received_token == door->session_token) &&
+	        (door->session_uses < SESSION_MAX_USES) && (!admin || (door->session_flags & USER_DB_FLAG_ADMIN))) ;
+}
+
+/*
+ * The header bytes are only stored, the token is checked once the PIN is received, so the
+ * frames of a rejected command are never read as new commands.
+ */
+void Control_ECU_receiveUser(DoorContext *door,uint8 frame)
+{
+	switch(door->index)
+	{
+	case 0 :
+	case 1 :
+		door->received_token = (door->received_token << 8) | frame ;
+		break;
+	case 2 :
+	case 3 :
+		door->pending_user.user_id = (door->pending_user.user_id << 8) | frame ;
+		break;
+	case 4 :
+		door->pending_user.doors = frame ;
+		break;
+	default :
+		door->pending_user.flags = frame ;
+		break;
+	}
+	door->index++ ;
+
+	if(door->index == ((door->command == USER_ENROLL_TOKEN_CMD) ? USER_ENROLL_HEADER_SIZE : SESSION_TOKEN_SIZE))
+	{
+		Control_ECU_startEntry(door, FALSE);
+	}
+}
+
+/*
+ * The users table holds the PINs of the users, the master user is the door password so it is
+ * never enrolled. A user without any door of this ECU is not enrolled either.
+ */
+void Control_ECU_updateUser(DoorContext *door)
+{
+	uint8 result = USER_NOT_UPDATED ;
+
+	door->state = DOOR_IDLE ;
+	if(!Control_ECU_tokenValid(door, TRUE))
+	{
+		Control_ECU_closeSession(door);
+		Control_ECU_sendFrame(door, SESSION_REJECTED);
+		return ;
+	}
+
+	if(door->command == USER_ENROLL_TOKEN_CMD)
+	{
+		door->pending_user.doors &= DOOR_ALL_DOORS_MASK ;
+		door->pending_user.flags &= USER_DB_ALL_FLAGS_MASK ;
+		if((door->check_status == SUCCESSFUL_PASSWORD_CHECK) && (door->pending_user.user_id != DOOR_MASTER_USER_ID) &&
+		   (door->pending_user.doors != 0) && (UserDb_add(door->entry, PASSWORD_SIZE, &door->pending_user) == SUCCESS))
 		{
-			g_check_status = UNSUCCESSFUL_PASSWORD_CHECK ;
+			result = USER_UPDATED ;
 		}
+		AuditLog_log(AUDIT_EVENT_USER_ADD, door->id, door->session_user, (result == USER_UPDATED));
+	}
+	else
+	{
+		if((door->check_status == SUCCESSFUL_PASSWORD_CHECK) && (UserDb_remove(door->entry, PASSWORD_SIZE) == SUCCESS))
+		{
+			result = USER_UPDATED ;
+		}
+		AuditLog_log(AUDIT_EVENT_USER_REMOVE, door->id, door->session_user, (result == USER_UPDATED));
 	}
 
-	UART_sendByte(g_check_status);
+	Control_ECU_sendFrame(door, result);
+	Control_ECU_renewToken(door);
+	Control_ECU_sendFrame(door, (uint8)(door->session_token >> 8));
+	Control_ECU_sendFrame(door, (uint8)door->session_token);
+	Control_ECU_playBuzzer((result == USER_UPDATED) ? BUZZER_PATTERN_SUCCESS : BUZZER_PATTERN_FAILURE);
 }
 
-void Control_ECU_writePassword(uint8 *password_buffer,uint8 size)
+/*
+ * An accepted token is replaced, the session deadline of the password check is kept.
+ */
+void Control_ECU_renewToken(DoorContext *door)
 {
-	uint8 index ;
-	for(index = 0 ; index < size ; index++)
+	door->session_token = Control_ECU_nextNonce() ;
+	door->session_uses++ ;
+}
+
+void Control_ECU_openSession(DoorContext *door)
+{
+	door->session_token = Control_ECU_nextNonce() ;
+	door->session_timer = (SESSION_TIMEOUT * CONTROL_TICKS_PER_SECOND) ;
+	door->session_uses = 0 ;
+
+	/* The door password (change and create checks) opens a master session */
+	if(door->command == OPEN_DOOR_CMD)
+	{
+		door->session_user = door->user_id ;
+		door->session_flags = door->user_flags ;
+	}
+	else
 	{
-		EEPROM_writeByte((0x0311+index), password_buffer[index]);
+		door->session_user = DOOR_MASTER_USER_ID ;
+		door->session_flags = USER_DB_FLAG_ADMIN ;
 	}
 }
 
-void Control_ECU_checkSavedPassword(uint8 *password_buffer_1,uint8 *password_buffer_2,uint8 size)
+/*
+ * The change authorization belongs to the session, a closed session does not allow a password create.
+ */
+void Control_ECU_closeSession(DoorContext *door)
 {
-	g_check_status = SUCCESSFUL_PASSWORD_CHECK ;
-	uint8 index ;
-	for(index = 0 ; index < size ; index++)
+	door->session_token = SESSION_NO_TOKEN ;
+	door->session_timer = 0 ;
+	door->change_allowed = FALSE ;
+}
+
+/*
+ * Xorshift generator (7,9,8) over the 16-bit nonce, the Timer1 count at the request time is mixed in
+ * so the sequence depends on when the users type. It never returns SESSION_NO_TOKEN.
+ */
+uint16 Control_ECU_nextNonce(void)
+{
+	g_nonce ^= TCNT1 ;
+	if(g_nonce == 0)
 	{
-		EEPROM_readByte((0x0311+index), &password_buffer_2[index]);
+		g_nonce = 1 ;
 	}
-	for(index = 0 ; index < size ; index++)
+	g_nonce ^= (g_nonce << 7) ;
+	g_nonce ^= (g_nonce >> 9) ;
+	g_nonce ^= (g_nonce << 8) ;
+
+	return g_nonce ;
+}
+
+/*
+ * The HMI does not count the faults, the wrong password of an open or change check that reaches
+ * max_faults is replied as the lock-out with its time.
+ */
+void Control_ECU_replyCheckStatus(DoorContext *door)
+{
+	if((door->check_status != SUCCESSFUL_PASSWORD_CHECK) && (door->command != CREATE_PASSWORD_CMD) &&
+	   ((door->count_faults + 1) >= g_settings.max_faults))
+	{
+		Control_ECU_sendFrame(door, LOCKED_OUT_PASSWORD_CHECK);
+		Control_ECU_sendFrame(door, g_settings.alarm_time);
+	}
+	else
+	{
+		Control_ECU_sendFrame(door, door->check_status);
+	}
+
+	if(door->check_status == SUCCESSFUL_PASSWORD_CHECK)
 	{
-		if(password_buffer_1[index] != password_buffer_2[index])
+		if(door->state == DOOR_RECEIVING_TOKEN)
 		{
-			g_check_status = UNSUCCESSFUL_PASSWORD_CHECK ;
+			Control_ECU_renewToken(door);
 		}
+		else
+		{
+			Control_ECU_openSession(door);
+		}
+		Control_ECU_sendFrame(door, (uint8)(door->session_token >> 8));
+		Control_ECU_sendFrame(door, (uint8)door->session_token);
 	}
+	else
+	{
+		door->session_token = SESSION_NO_TOKEN ;
+		door->session_timer = 0 ;
+	}
+	Control_ECU_playBuzzer((door->check_status == SUCCESSFUL_PASSWORD_CHECK) ? BUZZER_PATTERN_SUCCESS : BUZZER_PATTERN_FAILURE);
+}
 
-	UART_sendByte(g_check_status);
+void Control_ECU_writePassword(const DoorContext *door)
+{
+	/* One page write, the updates are spread over the store region */
+	LogStore_write((DOOR_PASSWORD_KEY + door->id), door->reference, PASSWORD_SIZE);
 }
 
-void Control_ECU_controllingDcMotorConfig(void)
+void Control_ECU_readSavedPassword(DoorContext *door)
 {
-	g_counter = 0 ;
-	Timer1_setCallBack(Control_ECU_callBackFunction);
-	Timer1_ConfigType Timer1_ConfigStruct;
-	Timer1_ConfigStruct.mode = Timer1_Compare_Mode ;
-	Timer1_ConfigStruct.prescaler = F_CPU_1024 ;
-	Timer1_ConfigStruct.initial_value = 0 ;
-	Timer1_ConfigStruct.compare_value = 7812 ;
-	Timer1_init(&Timer1_ConfigStruct);
-	while(!(g_counter == 33))
+	if(LogStore_read((DOOR_PASSWORD_KEY + door->id), door->reference, PASSWORD_SIZE) != SUCCESS)
 	{
-		if(g_counter < 15)
+		EEPROM_readBlock(DOOR_LEGACY_PASSWORD_ADDRESS(door->id), door->reference, PASSWORD_SIZE);
+	}
+}
+
+void Control_ECU_startMove(DoorContext *door)
+{
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+	DcMotor_attach(door->motor);
+#endif
+
+	if(door->state == DOOR_WAIT_UNLOCK)
+	{
+		/* Unlocking, the motor stops on the open limit or on the profile safety timeout */
+		door->lock_retries = DOOR_LOCK_RETRIES ;
+		door->state = DOOR_UNLOCKING ;
+		DcMotor_startProfile(MOTOR_CW, DOOR_MOTOR_PROFILE);
+	}
+	else
+	{
+		/* Locking, the motor stops on the closed limit or on the profile safety timeout */
+		if(!door->jammed)
+		{
+			Control_ECU_sendFrame(door, DOOR_LOCKING_EVENT);
+		}
+		door->state = DOOR_LOCKING ;
+		DcMotor_startProfile(MOTOR_ACW, DOOR_MOTOR_PROFILE);
+	}
+}
+
+void Control_ECU_moveDone(DoorContext *door)
+{
+	if(DcMotor_getStopReason() == DC_MOTOR_STOP_STALL)
+	{
+		/* The motor is already stopped by the current monitor, the door is not left unlocked */
+		AuditLog_log(AUDIT_EVENT_DOOR_JAMMED, door->id, door->user_id, FALSE);
+		if(!door->jammed)
 		{
-			DcMotor_Rotate(MOTOR_CW, 100);
+			Control_ECU_sendFrame(door, DOOR_JAMMED_EVENT);
 		}
-		if(g_counter == 15)
+		if(door->lock_retries != 0)
 		{
-			DcMotor_Rotate(MOTOR_OFF, 0);
+			door->lock_retries-- ;
+			door->state = DOOR_WAIT_LOCK ;
 		}
-		if(g_counter == 18)
+		else
 		{
-			DcMotor_Rotate(MOTOR_ACW, 100);
+			door->jammed = TRUE ;
+			Control_ECU_startAlarm(door);
 		}
 	}
-	Timer1_deInit();
-	DcMotor_Rotate(MOTOR_OFF, 0);
-	g_counter = 0 ;
+	else if(door->state == DOOR_UNLOCKING)
+	{
+		Control_ECU_sendFrame(door, DOOR_UNLOCKED_EVENT);
+		door->timer = ((uint16)g_settings.hold_time * CONTROL_TICKS_PER_SECOND) ;
+		door->state = DOOR_UNLOCKED ;
+	}
+	else
+	{
+		if(!door->jammed)
+		{
+			Control_ECU_sendFrame(door, DOOR_LOCKED_EVENT);
+		}
+		door->jammed = FALSE ;
+		door->state = DOOR_IDLE ;
+	}
 }
 
-void Control_ECU_activateBuzzerConfig(void)
+void Control_ECU_sendFrame(const DoorContext *door,uint8 frame)
 {
-	g_counter = 0 ;
-	Timer1_setCallBack(Control_ECU_callBackFunction);
-	Timer1_ConfigType Timer1_ConfigStruct;
-	Timer1_ConfigStruct.mode = Timer1_Compare_Mode ;
-	Timer1_ConfigStruct.prescaler = F_CPU_1024 ;
-	Timer1_ConfigStruct.initial_value = 0 ;
-	Timer1_ConfigStruct.compare_value = 7812 ;
-	Timer1_init(&Timer1_ConfigStruct);
-	while(!(g_counter == 60))
+	UART_sendNineBit(DOOR_ADDRESS_FRAME(door->id));
+	UART_sendNineBit(frame);
+}
+
+/*
+ * The dump is a maintenance command, the stream is sent after one address frame and
+ * the doors wait for it to end.
+ */
+void Control_ECU_serviceToolFrame(uint8 frame)
+{
+	if(frame == AUDIT_DUMP_CMD)
+	{
+		UART_sendNineBit(DOOR_ADDRESS_FRAME(SERVICE_TOOL_ID));
+		AuditLog_dump(Control_ECU_sendServiceByte);
+	}
+}
+
+void Control_ECU_sendServiceByte(uint8 data)
+{
+	UART_sendNineBit(data);
+}
+
+/*
+ * The buzzer is shared by the doors, the lock-out alarm is not interrupted by the other doors sounds.
+ */
+void Control_ECU_playBuzzer(uint8 pattern_id)
+{
+	if(!Control_ECU_alarmActive())
 	{
-		Buzzer_on();
+		Buzzer_play(pattern_id);
 	}
-	Timer1_deInit();
-	Buzzer_off();
-	g_counter = 0 ;
+}
+
+boolean Control_ECU_alarmActive(void)
+{
+	uint8 id ;
+
+	for(id = 0 ; id < NUM_OF_DOORS ; id++)
+	{
+		if(g_doors[id].state == DOOR_ALARM)
+		{
+			return TRUE ;
+		}
+	}
+
+	return FALSE ;
 }
 
 void Control_ECU_callBackFunction(void)
@@ -0,0 +1,334 @@
+/*
+ ============================================================================
+ Name        : audit_log.c
+ Author      : Ahmed Shawky
+ Description : Source File for Audit Log Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <util/crc16.h>
+#include "audit_log.h"
+#include "storage.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+#define AUDIT_LOG_RECORDS_PER_PAGE 		(EEPROM_PAGE_SIZE / AUDIT_LOG_RECORD_SIZE)
+
+#define AUDIT_LOG_RECORD_ADDRESS(index) (AUDIT_LOG_START_ADDRESS + ((uint32)(index) * AUDIT_LOG_RECORD_SIZE))
+
+/* An erased record reads all ones */
+#define AUDIT_LOG_ERASED_TIMESTAMP 		0xFFFFFFFFUL
+
+/* A ring segment is streamed by one read of 16-bit size */
+#if((AUDIT_LOG_NUM_OF_RECORDS * AUDIT_LOG_RECORD_SIZE) > 0xFFFFUL)
+#error "The audit log ring is too large"
+#endif
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Records not committed yet, in the logging order */
+static AuditLog_RecordType g_buffer[AUDIT_LOG_BUFFER_SIZE] ;
+static uint8 g_bufferCount ;
+
+/* Ring index of the next committed record and the number of records in the ring */
+static uint16 g_next ;
+static uint16 g_records ;
+
+/* The log clock and the timestamp of the latest logged record */
+static uint32 g_clock ;
+static uint32 g_lastTimestamp ;
+
+/* Seconds since the last logged record */
+static uint8 g_idleTime ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for calculating the CRC of a record.
+ */
+static uint8 AuditLog_crc(const AuditLog_RecordType *record);
+
+/*
+ * Function responsible for reading a ring record, it returns FALSE for an erased or a torn record.
+ */
+static boolean AuditLog_readRecord(uint16 index,AuditLog_RecordType *record);
+
+/*
+ * Function responsible for streaming a ring segment from the log storage.
+ */
+static uint8 AuditLog_stream(uint16 index,uint16 count,void(*a_ptr)(uint8));
+
+/*
+ * Function responsible for committing the buffered records up to the end of the current page.
+ */
+static uint8 AuditLog_commit(void);
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Find the latest record by a binary search over the ring timestamps and continue the
+ *	clock from it. The TWI driver must be initialized before.
+ */
+void AuditLog_init(void)
+{
+	AuditLog_RecordType record ;
+	uint32 reference_timestamp ;
+	uint16 reference ;
+	uint16 low ;
+	uint16 high ;
+	uint16 middle ;
+
+	g_bufferCount = 0 ;
+	g_next = 0 ;
+	g_records = 0 ;
+	g_clock = 0 ;
+	g_lastTimestamp = 0 ;
+	g_idleTime = 0 ;
+
+	/* The reference is the first valid record, a torn commit may have left the first page invalid */
+	for(reference = 0 ; reference <= AUDIT_LOG_RECORDS_PER_PAGE ; reference++)
+	{
+		if(AuditLog_readRecord(reference, &record))
+		{
+			break ;
+		}
+	}
+	if(reference > AUDIT_LOG_RECORDS_PER_PAGE)
+	{
+		/* Empty log */
+		return ;
+	}
+	reference_timestamp = record.timestamp ;
+
+	/*
+	 * The timestamps are unique and increasing, the records from the reference up to the latest
+	 * record are newer than the reference and the records after it are older (or erased).
+	 */
+	low = reference ;
+	high = AUDIT_LOG_NUM_OF_RECORDS - 1 ;
+	while(low < high)
+	{
+		middle = (uint16)((low + high + 1) / 2) ;
+		if(AuditLog_readRecord(middle, &record) && (record.timestamp >= reference_timestamp))
+		{
+			low = middle ;
+		}
+		else
+		{
+			high = middle - 1 ;
+		}
+	}
+
+	AuditLog_readRecord(low, &record);
+	g_clock = record.timestamp ;
+	g_lastTimestamp = record.timestamp ;
+	g_next = ((low + 1) < AUDIT_LOG_NUM_OF_RECORDS) ? (low + 1) : 0 ;
+
+	/* The ring has wrapped if the record after the latest one is valid */
+	g_records = AuditLog_readRecord(g_next, &record) ? AUDIT_LOG_NUM_OF_RECORDS : (low + 1) ;
+}
+
+/* Inputs:
+ * 	1. type: The event type.
+ * 	2. door: The door id, it should be from 0 → 7.
+ * 	3. user_id: The user of the event or AUDIT_LOG_NO_USER.
+ * 	4. result: TRUE if the event succeeded.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Add a record to the RAM buffer, it does not access the EEPROM.
+ */
+void AuditLog_log(uint8 type, uint8 door, uint16 user_id, boolean result)
+{
+	AuditLog_RecordType *record ;
+
+	if(g_bufferCount == AUDIT_LOG_BUFFER_SIZE)
+	{
+		return ;
+	}
+
+	/* The records of the same second get the next seconds, so the timestamps stay unique */
+	g_lastTimestamp = (g_clock > g_lastTimestamp) ? g_clock : (g_lastTimestamp + 1) ;
+
+	record = &g_buffer[g_bufferCount] ;
+	record->timestamp = g_lastTimestamp ;
+	record->user_id = user_id ;
+	record->event = (uint8)((type << 4) | ((door & 0x07) << 1) | (result ? 1 : 0)) ;
+	record->crc = AuditLog_crc(record) ;
+
+	g_bufferCount++ ;
+	g_idleTime = 0 ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Advance the log clock by one second, it is called every second.
+ */
+void AuditLog_tick(void)
+{
+	g_clock++ ;
+	if(g_idleTime < 0xFF)
+	{
+		g_idleTime++ ;
+	}
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Commit the buffered records, it is called from the main loop. Every commit is one
+ *	queued write inside one EEPROM page.
+ */
+void AuditLog_service(void)
+{
+	uint8 space = (uint8)(AUDIT_LOG_RECORDS_PER_PAGE - (g_next % AUDIT_LOG_RECORDS_PER_PAGE)) ;
+
+	/* A full page is committed at once, a partial page waits for more records up to the flush time */
+	if((g_bufferCount >= space) || ((g_bufferCount != 0) && (g_idleTime >= AUDIT_LOG_FLUSH_TIME)))
+	{
+		AuditLog_commit();
+	}
+}
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter uint8 and return void.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Commit the buffered records then stream the number of records (2 bytes, high byte first)
+ *	and the records from the oldest one. In the external EEPROM every ring segment is streamed
+ *	by one sequential read.
+ */
+uint8 AuditLog_dump(void(*a_ptr)(uint8))
+{
+	while(g_bufferCount != 0)
+	{
+		if(AuditLog_commit() == ERROR)
+		{
+			return ERROR ;
+		}
+	}
+
+	(*a_ptr)((uint8)(g_records >> 8));
+	(*a_ptr)((uint8)g_records);
+
+	/* After the ring wraps the oldest record is the next one to be overwritten */
+	if(g_records == AUDIT_LOG_NUM_OF_RECORDS)
+	{
+		if(AuditLog_stream(g_next, (uint16)(AUDIT_LOG_NUM_OF_RECORDS - g_next), a_ptr) == ERROR)
+		{
+			return ERROR ;
+		}
+	}
+
+	return AuditLog_stream(0, g_next, a_ptr) ;
+}
+
+static uint8 AuditLog_crc(const AuditLog_RecordType *record)
+{
+	const uint8 *bytes = (const uint8*)record ;
+	uint8 crc = 0 ;
+	uint8 index ;
+
+	for(index = 0 ; index < (uint8)(sizeof(AuditLog_RecordType) - sizeof(record->crc)) ; index++)
+	{
+		crc = _crc8_ccitt_update(crc, bytes[index]);
+	}
+
+	return crc ;
+}
+
+static boolean AuditLog_readRecord(uint16 index,AuditLog_RecordType *record)
+{
+	if(AUDIT_LOG_STORAGE.readBlock(AUDIT_LOG_RECORD_ADDRESS(index), (uint8*)record, sizeof(AuditLog_RecordType)) == ERROR)
+	{
+		return FALSE ;
+	}
+
+	return ((record->timestamp != AUDIT_LOG_ERASED_TIMESTAMP) && (record->crc == AuditLog_crc(record))) ;
+}
+
+static uint8 AuditLog_stream(uint16 index,uint16 count,void(*a_ptr)(uint8))
+{
+	AuditLog_RecordType record ;
+	uint8 byte ;
+
+	/* The external EEPROM streams a whole segment by one sequential read */
+	if(AUDIT_LOG_STORAGE.readBlock == EEPROM_readBlock)
+	{
+		return EEPROM_readStream(AUDIT_LOG_RECORD_ADDRESS(index), (uint16)(count * AUDIT_LOG_RECORD_SIZE), a_ptr) ;
+	}
+
+	while(count != 0)
+	{
+		if(AUDIT_LOG_STORAGE.readBlock(AUDIT_LOG_RECORD_ADDRESS(index), (uint8*)&record, sizeof(AuditLog_RecordType)) == ERROR)
+		{
+			return ERROR ;
+		}
+		for(byte = 0 ; byte < sizeof(AuditLog_RecordType) ; byte++)
+		{
+			(*a_ptr)(((const uint8*)&record)[byte]);
+		}
+		index++ ;
+		count-- ;
+	}
+
+	return SUCCESS ;
+}
+
+static uint8 AuditLog_commit(void)
+{
+	uint8 count = (uint8)(AUDIT_LOG_RECORDS_PER_PAGE - (g_next % AUDIT_LOG_RECORDS_PER_PAGE)) ;
+	uint8 index ;
+
+	if(count > g_bufferCount)
+	{
+		count = g_bufferCount ;
+	}
+
+	/* One queued write inside the page, the door path never waits for it */
+	if(AUDIT_LOG_STORAGE.writeBlock(AUDIT_LOG_RECORD_ADDRESS(g_next), (const uint8*)g_buffer, (uint16)(count * AUDIT_LOG_RECORD_SIZE)) == ERROR)
+	{
+		return ERROR ;
+	}
+
+	for(index = count ; index < g_bufferCount ; index++)
+	{
+		g_buffer[index - count] = g_buffer[index] ;
+	}
+	g_bufferCount -= count ;
+
+	g_next += count ;
+	if(g_next == AUDIT_LOG_NUM_OF_RECORDS)
+	{
+		g_next = 0 ;
+	}
+	if(g_records < AUDIT_LOG_NUM_OF_RECORDS)
+	{
+		g_records += count ;
+	}
+
+	return SUCCESS ;
+}
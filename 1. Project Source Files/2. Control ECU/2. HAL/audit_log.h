@@ -0,0 +1,153 @@
+/*
+ ============================================================================
+ Name        : audit_log.h
+ Author      : Ahmed Shawky
+ Description : Header File for Audit Log Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef AUDIT_LOG_H_
+#define AUDIT_LOG_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+#include "storage.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * The storage backend of the log, Storage_internalEeprom keeps the records on-chip and then
+ * the ring must be in the first INTERNAL_EEPROM_SIZE bytes.
+ */
+#define AUDIT_LOG_STORAGE 				Storage_externalEeprom
+
+/*
+ * The log ring in the storage, the newest records overwrite the oldest ones.
+ * The start address must be page aligned.
+ */
+#define AUDIT_LOG_START_ADDRESS 		0x0000
+#define AUDIT_LOG_NUM_OF_RECORDS 		96
+#define AUDIT_LOG_RECORD_SIZE 			8
+
+/*
+ * The records are buffered in RAM and committed when they fill the rest of the current EEPROM
+ * page, or AUDIT_LOG_FLUSH_TIME seconds after the last record. A record logged while the
+ * buffer is full is dropped.
+ */
+#define AUDIT_LOG_BUFFER_SIZE 			4
+#define AUDIT_LOG_FLUSH_TIME 			5
+
+#if((EEPROM_PAGE_SIZE % AUDIT_LOG_RECORD_SIZE) != 0)
+#error "An audit log record must not cross an EEPROM page"
+#endif
+
+#if((AUDIT_LOG_NUM_OF_RECORDS % (EEPROM_PAGE_SIZE / AUDIT_LOG_RECORD_SIZE)) != 0)
+#error "The audit log ring must be whole EEPROM pages"
+#endif
+
+#if(STORAGE_IS_INTERNAL(AUDIT_LOG_STORAGE) && \
+   ((AUDIT_LOG_START_ADDRESS + (AUDIT_LOG_NUM_OF_RECORDS * AUDIT_LOG_RECORD_SIZE)) > INTERNAL_EEPROM_SIZE))
+#error "The audit log ring is past the end of the internal EEPROM"
+#endif
+
+/* Event types, in the high nibble of the record event byte */
+#define AUDIT_EVENT_BOOT 				0x01
+#define AUDIT_EVENT_PASSWORD_CREATE 	0x02
+#define AUDIT_EVENT_DOOR_OPEN 			0x03
+#define AUDIT_EVENT_PASSWORD_CHECK 		0x04
+#define AUDIT_EVENT_LOCKOUT 			0x05
+#define AUDIT_EVENT_DOOR_JAMMED 		0x06
+#define AUDIT_EVENT_USER_ADD 			0x07
+#define AUDIT_EVENT_USER_REMOVE 		0x08
+
+/* Record event byte: event type (bits 7:4), door id (bits 3:1) and result (bit 0) */
+#define AUDIT_LOG_EVENT_TYPE(event) 	((uint8)((event) >> 4))
+#define AUDIT_LOG_EVENT_DOOR(event) 	((uint8)(((event) >> 1) & 0x07))
+#define AUDIT_LOG_EVENT_RESULT(event) 	((uint8)((event) & 0x01))
+
+/* User id of the events without a user */
+#define AUDIT_LOG_NO_USER 				0xFFFF
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+/* One record, it is AUDIT_LOG_RECORD_SIZE bytes in the EEPROM and in the dump stream */
+typedef struct
+{
+	/* Seconds of operation, they continue from the latest record after a reset */
+	uint32 timestamp ;
+
+	uint16 user_id ;
+
+	uint8 event ;
+
+	/* CRC-8 of the record bytes before it */
+	uint8 crc ;
+
+}AuditLog_RecordType;
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Find the latest record by a binary search over the ring timestamps and continue the
+ *	clock from it. The TWI driver must be initialized before.
+ */
+void AuditLog_init(void);
+
+/* Inputs:
+ * 	1. type: The event type.
+ * 	2. door: The door id, it should be from 0 → 7.
+ * 	3. user_id: The user of the event or AUDIT_LOG_NO_USER.
+ * 	4. result: TRUE if the event succeeded.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Add a record to the RAM buffer, it does not access the EEPROM.
+ */
+void AuditLog_log(uint8 type, uint8 door, uint16 user_id, boolean result);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Advance the log clock by one second, it is called every second.
+ */
+void AuditLog_tick(void);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Commit the buffered records, it is called from the main loop. Every commit is one
+ *	queued write inside one EEPROM page.
+ */
+void AuditLog_service(void);
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter uint8 and return void.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Commit the buffered records then stream the number of records (2 bytes, high byte first)
+ *	and the records from the oldest one. In the external EEPROM every ring segment is streamed
+ *	by one sequential read.
+ */
+uint8 AuditLog_dump(void(*a_ptr)(uint8));
+
+#endif /* AUDIT_LOG_H_ */
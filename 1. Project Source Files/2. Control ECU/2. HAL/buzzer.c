@@ -10,8 +10,71 @@
 /****************************************************************************
  * 								  Includes								    *
  ****************************************************************************/
+#include <avr/io.h>
+#include <avr/pgmspace.h>
 #include "buzzer.h"
 
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Notes of all the patterns in flash */
+static const Buzzer_NoteType g_notes[] PROGMEM =
+{
+	/* BUZZER_PATTERN_KEY_CLICK */
+	BUZZER_NOTE(4000, 5, 0),
+
+	/* BUZZER_PATTERN_SUCCESS: rising two tones */
+	BUZZER_NOTE(1000, 80, 40),
+	BUZZER_NOTE(2000, 120, 0),
+
+	/* BUZZER_PATTERN_FAILURE: two short low beeps then a long lower one */
+	BUZZER_NOTE(500, 150, 80),
+	BUZZER_NOTE(500, 150, 80),
+	BUZZER_NOTE(300, 400, 0),
+
+	/* BUZZER_PATTERN_ALARM: two tones siren */
+	BUZZER_NOTE(2000, 250, 0),
+	BUZZER_NOTE(1500, 250, 0)
+};
+
+/* Patterns table in flash */
+static const Buzzer_PatternType g_patterns[BUZZER_NUM_OF_PATTERNS] PROGMEM =
+{
+	/* first_note, num_of_notes, loop */
+	{ 0, 1, FALSE },	/* BUZZER_PATTERN_KEY_CLICK */
+	{ 1, 2, FALSE },	/* BUZZER_PATTERN_SUCCESS */
+	{ 3, 3, FALSE },	/* BUZZER_PATTERN_FAILURE */
+	{ 6, 2, TRUE  }		/* BUZZER_PATTERN_ALARM */
+};
+
+/* Pattern player state, it is updated from the Timer2 compare interrupt */
+static volatile boolean g_playing = FALSE ;
+static Buzzer_PatternType g_pattern ;
+static uint8 g_noteIndex ;
+static Buzzer_NoteType g_note ;
+static boolean g_inTone ;
+static uint16 g_count ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Timer2 compare Call Back function, it toggles the pin during a tone and counts the silences.
+ */
+static void Buzzer_tick(void);
+
+/*
+ * Function responsible for loading the current note from flash and starting its tone.
+ */
+static void Buzzer_startNote(void);
+
+/*
+ * Function responsible for moving to the next note, the pattern repeats or ends after the last one.
+ */
+static void Buzzer_nextNote(void);
+
 /****************************************************************************
  * 							Functions Definitions						    *
  ****************************************************************************/
@@ -53,4 +116,126 @@ void Buzzer_off(void)
 	GPIO_writePin(BUZZER_PORT_ID, BUZZER_PIN_ID, LOGIC_LOW);
 }
 
+/* Inputs:
+ * 	1. pattern_id: The required pattern from the flash patterns table.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start playing a pattern of notes, the tones and the silences are generated by the
+ *	Timer2 compare interrupt so the function returns at once. A new pattern replaces
+ *	the playing one.
+ */
+void Buzzer_play(uint8 pattern_id)
+{
+	if(pattern_id >= BUZZER_NUM_OF_PATTERNS)
+	{
+		return ;
+	}
+
+	Buzzer_stop();
+
+	memcpy_P(&g_pattern, &g_patterns[pattern_id], sizeof(Buzzer_PatternType));
+	g_noteIndex = g_pattern.first_note ;
+	g_playing = TRUE ;
+
+	Timer2_setCallBack(Buzzer_tick);
+	Buzzer_startNote();
+
+	/* The note sets the first compare value, the timer starts counting from 0 */
+	Timer2_ConfigType Timer2_ConfigStruct ;
+	Timer2_ConfigStruct.mode = Timer2_Compare_Mode ;
+	Timer2_ConfigStruct.prescaler = BUZZER_TIMER2_PRESCALER ;
+	Timer2_ConfigStruct.initial_value = 0 ;
+	Timer2_ConfigStruct.compare_value = g_inTone ? g_note.compare : BUZZER_SILENCE_COMPARE ;
+	Timer2_init(&Timer2_ConfigStruct);
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop the playing pattern, stop Timer2 and turn off the buzzer.
+ */
+void Buzzer_stop(void)
+{
+	Timer2_deInit();
+	g_playing = FALSE ;
+	Buzzer_off();
+}
 
+/* Inputs: void.
+ *
+ * Return Value: TRUE while a pattern is playing.
+ *
+ * Description:
+ *	Check if the buzzer is still playing a pattern.
+ */
+boolean Buzzer_isPlaying(void)
+{
+	return g_playing ;
+}
+
+static void Buzzer_tick(void)
+{
+	if(g_inTone)
+	{
+		TOGGLE_BIT(BUZZER_PORT_REG, BUZZER_PIN_ID);
+		if(--g_count != 0)
+		{
+			return ;
+		}
+
+		/* End of the tone, the pin is left low during the silence */
+		CLEAR_BIT(BUZZER_PORT_REG, BUZZER_PIN_ID);
+		g_inTone = FALSE ;
+		g_count = g_note.silence_time ;
+		if(g_count != 0)
+		{
+			Timer2_setCompareValue(BUZZER_SILENCE_COMPARE);
+			return ;
+		}
+	}
+	else if(--g_count != 0)
+	{
+		return ;
+	}
+
+	Buzzer_nextNote();
+}
+
+static void Buzzer_startNote(void)
+{
+	memcpy_P(&g_note, &g_notes[g_noteIndex], sizeof(Buzzer_NoteType));
+
+	if(g_note.tone_toggles != 0)
+	{
+		g_inTone = TRUE ;
+		g_count = g_note.tone_toggles ;
+		Timer2_setCompareValue(g_note.compare);
+	}
+	else
+	{
+		/* A rest note */
+		g_inTone = FALSE ;
+		g_count = g_note.silence_time ;
+		Timer2_setCompareValue(BUZZER_SILENCE_COMPARE);
+	}
+}
+
+static void Buzzer_nextNote(void)
+{
+	g_noteIndex++ ;
+	if(g_noteIndex == (g_pattern.first_note + g_pattern.num_of_notes))
+	{
+		if(!g_pattern.loop)
+		{
+			Buzzer_stop();
+			return ;
+		}
+		g_noteIndex = g_pattern.first_note ;
+	}
+
+	Buzzer_startNote();
+}
@@ -16,6 +16,7 @@
 #include "gpio.h"
 #include "std_types.h"
 #include "common_macros.h"
+#include "timer2.h"
 
 /****************************************************************************
  * 								 Definitions								*
@@ -23,6 +24,63 @@
 #define BUZZER_PORT_ID 		PORTB_ID
 #define BUZZER_PIN_ID 		PIN0_ID
 
+/* The tone interrupt toggles the pin register directly */
+#define BUZZER_PORT_REG 	PORTB
+
+/*
+ * Tone generator: Timer2 in CTC mode with F_CPU/64, every compare interrupt toggles the buzzer
+ * pin so the tone frequency is F_CPU / (2 * 64 * (OCR2 + 1)), from 245Hz to 62.5KHz at 8MHz.
+ * While a note is silent OCR2 gives a 1ms period to count the silence time.
+ */
+#define BUZZER_TIMER2_PRESCALER 		Timer2_F_CPU_64
+#define BUZZER_TIMER2_TICKS_PER_MS 		(F_CPU / (64UL * 1000UL))
+#define BUZZER_TONE_COMPARE(freq) 		((uint8)((F_CPU / (2UL * 64UL * (freq))) - 1))
+#define BUZZER_SILENCE_COMPARE 			((uint8)(BUZZER_TIMER2_TICKS_PER_MS - 1))
+
+/*
+ * Note of a pattern: a tone of (freq) Hz for (on_ms) then a silence for (off_ms).
+ * The compare value and the number of pin toggles are calculated at compile time.
+ */
+#define BUZZER_NOTE(freq,on_ms,off_ms) 	{ BUZZER_TONE_COMPARE(freq), \
+										  (uint16)(((uint32)(on_ms) * BUZZER_TIMER2_TICKS_PER_MS) / (BUZZER_TONE_COMPARE(freq) + 1UL)), \
+										  (off_ms) }
+
+/* Patterns IDs */
+#define BUZZER_PATTERN_KEY_CLICK 		0
+#define BUZZER_PATTERN_SUCCESS 			1
+#define BUZZER_PATTERN_FAILURE 			2
+#define BUZZER_PATTERN_ALARM 			3
+#define BUZZER_NUM_OF_PATTERNS 			4
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef struct
+{
+	/* Timer2 compare value of the tone frequency */
+	uint8 compare ;
+
+	/* Number of pin toggles (half periods) of the tone */
+	uint16 tone_toggles ;
+
+	/* Silence after the tone in ms */
+	uint16 silence_time ;
+
+}Buzzer_NoteType;
+
+typedef struct
+{
+	/* Index of the first note in the notes table */
+	uint8 first_note ;
+
+	uint8 num_of_notes ;
+
+	/* The pattern repeats until Buzzer_stop() */
+	boolean loop ;
+
+}Buzzer_PatternType;
+
 /****************************************************************************
  * 							Functions Prototypes						    *
  ****************************************************************************/
@@ -55,4 +113,34 @@ void Buzzer_on(void);
  */
 void Buzzer_off(void);
 
+/* Inputs:
+ * 	1. pattern_id: The required pattern from the flash patterns table.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start playing a pattern of notes, the tones and the silences are generated by the
+ *	Timer2 compare interrupt so the function returns at once. A new pattern replaces
+ *	the playing one.
+ */
+void Buzzer_play(uint8 pattern_id);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop the playing pattern, stop Timer2 and turn off the buzzer.
+ */
+void Buzzer_stop(void);
+
+/* Inputs: void.
+ *
+ * Return Value: TRUE while a pattern is playing.
+ *
+ * Description:
+ *	Check if the buzzer is still playing a pattern.
+ */
+boolean Buzzer_isPlaying(void);
+
 #endif /* BUZZER_H_ */
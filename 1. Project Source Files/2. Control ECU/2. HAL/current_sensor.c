@@ -0,0 +1,180 @@
+/*
+ ============================================================================
+ Name        : current_sensor.c
+ Author      : Ahmed Shawky
+ Description : Source File for Motor Current Sensor Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "current_sensor.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/* The threshold is compared with the window sum, so no division is done per sample */
+#define CURRENT_SENSOR_STALL_SUM 		((uint16)(CURRENT_SENSOR_MA_TO_ADC(CURRENT_SENSOR_STALL_MA) * CURRENT_SENSOR_FILTER_SIZE))
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Moving average window and its running sum */
+static uint16 g_window[CURRENT_SENSOR_FILTER_SIZE] ;
+static uint8 g_windowIndex ;
+static volatile uint16 g_windowSum ;
+static volatile uint16 g_peakSum ;
+
+static uint16 g_blankingSamples ;
+static uint8 g_stallSamples ;
+
+static void (*volatile g_stallCallBackPtr)(void) = NULL_PTR ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * ADC Call Back function, it filters every sample and checks the stall threshold.
+ */
+static void CurrentSensor_sample(uint16 sample);
+
+/*
+ * Function responsible for converting a window sum to mA.
+ */
+static uint16 CurrentSensor_sumToMilliAmps(uint16 sum);
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to the Call Back function to be called once on a stall.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start the ADC free running on the sensor channel and the stall monitor,
+ *	the Call Back function is called from the ADC interrupt.
+ */
+void CurrentSensor_start(void(*stall_callback)(void))
+{
+	uint8 i ;
+
+	ADC_deInit();
+
+	for(i = 0 ; i < CURRENT_SENSOR_FILTER_SIZE ; i++)
+	{
+		g_window[i] = 0 ;
+	}
+	g_windowIndex = 0 ;
+	g_windowSum = 0 ;
+	g_peakSum = 0 ;
+	g_blankingSamples = CURRENT_SENSOR_BLANKING_SAMPLES ;
+	g_stallSamples = 0 ;
+	g_stallCallBackPtr = stall_callback ;
+
+	ADC_setCallBack(CurrentSensor_sample);
+
+	ADC_ConfigType ADC_ConfigStruct ;
+	ADC_ConfigStruct.ref_volt = ADC_AVCC ;
+	ADC_ConfigStruct.prescaler = ADC_F_CPU_128 ;
+	ADC_ConfigStruct.channel = CURRENT_SENSOR_ADC_CHANNEL ;
+	ADC_init(&ADC_ConfigStruct);
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop the stall monitor and switch the ADC off.
+ */
+void CurrentSensor_stop(void)
+{
+	ADC_deInit();
+	g_stallCallBackPtr = NULL_PTR ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The filtered motor current in mA.
+ *
+ * Description:
+ *	Read the moving average of the motor current.
+ */
+uint16 CurrentSensor_getCurrent(void)
+{
+	uint16 sum ;
+	uint8 sreg = SREG ;
+	cli();
+	sum = g_windowSum ;
+	SREG = sreg ;
+	return CurrentSensor_sumToMilliAmps(sum) ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The highest filtered motor current in mA since the last start.
+ *
+ * Description:
+ *	Read the peak current of the last move, the blanking time is not included.
+ */
+uint16 CurrentSensor_getPeakCurrent(void)
+{
+	uint16 sum ;
+	uint8 sreg = SREG ;
+	cli();
+	sum = g_peakSum ;
+	SREG = sreg ;
+	return CurrentSensor_sumToMilliAmps(sum) ;
+}
+
+static void CurrentSensor_sample(uint16 sample)
+{
+	void (*stall_callback)(void) ;
+
+	/* Running sum of the last CURRENT_SENSOR_FILTER_SIZE samples */
+	g_windowSum = g_windowSum - g_window[g_windowIndex] + sample ;
+	g_window[g_windowIndex] = sample ;
+	g_windowIndex = ( g_windowIndex + 1 ) & ( CURRENT_SENSOR_FILTER_SIZE - 1 ) ;
+
+	if(g_blankingSamples != 0)
+	{
+		g_blankingSamples-- ;
+		return ;
+	}
+
+	if(g_windowSum > g_peakSum)
+	{
+		g_peakSum = g_windowSum ;
+	}
+
+	if(g_windowSum >= CURRENT_SENSOR_STALL_SUM)
+	{
+		g_stallSamples++ ;
+		if((g_stallSamples >= CURRENT_SENSOR_STALL_SAMPLES) && (g_stallCallBackPtr != NULL_PTR))
+		{
+			/* Report the stall once */
+			stall_callback = g_stallCallBackPtr ;
+			g_stallCallBackPtr = NULL_PTR ;
+			stall_callback();
+		}
+	}
+	else
+	{
+		g_stallSamples = 0 ;
+	}
+}
+
+static uint16 CurrentSensor_sumToMilliAmps(uint16 sum)
+{
+	/* The reading times the full scale current is 10M at most, the mV to mA factor would overflow 32 bits */
+	return (uint16)((((uint32)sum >> CURRENT_SENSOR_FILTER_SHIFT) * CURRENT_SENSOR_FULL_SCALE_MA) / 1024UL) ;
+}
@@ -0,0 +1,95 @@
+/*
+ ============================================================================
+ Name        : current_sensor.h
+ Author      : Ahmed Shawky
+ Description : Header File for Motor Current Sensor Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef CURRENT_SENSOR_H_
+#define CURRENT_SENSOR_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "adc.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/* The L293D ground current is measured on a shunt resistor amplified to ADC0 (PA0) */
+#define CURRENT_SENSOR_ADC_CHANNEL 		0
+#define CURRENT_SENSOR_VREF_MV 			5000
+
+/* Shunt resistance multiplied by the amplifier gain in milli-ohm (mV per A) */
+#define CURRENT_SENSOR_SHUNT_MOHM 		500
+
+/* The current at the ADC full scale in mA (10A), the ADC reading is scaled by it and 1024 */
+#define CURRENT_SENSOR_FULL_SCALE_MA 	((CURRENT_SENSOR_VREF_MV * 1000UL) / CURRENT_SENSOR_SHUNT_MOHM)
+
+#if(((1023UL * CURRENT_SENSOR_FULL_SCALE_MA) / 1024UL) > 0xFFFFUL)
+#error "The full scale current does not fit the 16-bit mA reading"
+#endif
+
+/* Scale a current in mA to the ADC reading, it is folded at compile time */
+#define CURRENT_SENSOR_MA_TO_ADC(ma) 	((uint16)(((uint32)(ma) * CURRENT_SENSOR_SHUNT_MOHM * 1024UL) / (1000UL * CURRENT_SENSOR_VREF_MV)))
+
+/*
+ * Moving average window in samples, it must be a power of 2.
+ * The ADC runs at F_CPU/128, so 16 samples are 3.3ms at 8MHz.
+ */
+#define CURRENT_SENSOR_FILTER_SIZE 		16
+#define CURRENT_SENSOR_FILTER_SHIFT 	4
+
+/* The motor is stalled when the filtered current stays above the threshold for this number of samples (2ms) */
+#define CURRENT_SENSOR_STALL_MA 		800
+#define CURRENT_SENSOR_STALL_SAMPLES 	10
+
+/* The start-up (inrush) current is not checked for this number of samples (200ms) */
+#define CURRENT_SENSOR_BLANKING_SAMPLES 960
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to the Call Back function to be called once on a stall.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start the ADC free running on the sensor channel and the stall monitor,
+ *	the Call Back function is called from the ADC interrupt.
+ */
+void CurrentSensor_start(void(*stall_callback)(void));
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop the stall monitor and switch the ADC off.
+ */
+void CurrentSensor_stop(void);
+
+/* Inputs: void.
+ *
+ * Return Value: The filtered motor current in mA.
+ *
+ * Description:
+ *	Read the moving average of the motor current.
+ */
+uint16 CurrentSensor_getCurrent(void);
+
+/* Inputs: void.
+ *
+ * Return Value: The highest filtered motor current in mA since the last start.
+ *
+ * Description:
+ *	Read the peak current of the last move, the blanking time is not included.
+ */
+uint16 CurrentSensor_getPeakCurrent(void);
+
+#endif /* CURRENT_SENSOR_H_ */
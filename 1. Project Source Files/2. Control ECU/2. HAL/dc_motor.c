@@ -10,7 +10,208 @@
 /****************************************************************************
  * 								  Includes								    *
  ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include "dc_motor.h"
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+#include "encoder.h"
+#endif
+#if(DC_MOTOR_STALL_DETECTION_ENABLE == TRUE)
+#include "current_sensor.h"
+#endif
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/* Pins of the driven motor, the attached channel or the fixed L293D pins */
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+#define DC_MOTOR_IN1_PORT 			(g_pins->in1_port)
+#define DC_MOTOR_IN1_PIN 			(g_pins->in1_pin)
+#define DC_MOTOR_IN2_PORT 			(g_pins->in2_port)
+#define DC_MOTOR_IN2_PIN 			(g_pins->in2_pin)
+#define DC_MOTOR_CW_LIMIT_PORT 		(g_pins->cw_limit_port)
+#define DC_MOTOR_CW_LIMIT_PIN 		(g_pins->cw_limit_pin)
+#define DC_MOTOR_ACW_LIMIT_PORT 	(g_pins->acw_limit_port)
+#define DC_MOTOR_ACW_LIMIT_PIN 		(g_pins->acw_limit_pin)
+#else
+#define DC_MOTOR_IN1_PORT 			L293D_IN1_PORT
+#define DC_MOTOR_IN1_PIN 			L293D_IN1_PIN
+#define DC_MOTOR_IN2_PORT 			L293D_IN2_PORT
+#define DC_MOTOR_IN2_PIN 			L293D_IN2_PIN
+#if(DC_MOTOR_LIMIT_POLLED == TRUE)
+#define DC_MOTOR_CW_LIMIT_PORT 		DC_MOTOR_CW_LIMIT_PORT_ID
+#define DC_MOTOR_CW_LIMIT_PIN 		DC_MOTOR_CW_LIMIT_PIN_ID
+#define DC_MOTOR_ACW_LIMIT_PORT 	DC_MOTOR_ACW_LIMIT_PORT_ID
+#define DC_MOTOR_ACW_LIMIT_PIN 		DC_MOTOR_ACW_LIMIT_PIN_ID
+#endif
+#endif
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+typedef enum
+{
+	RAMP_IDLE,
+	RAMP_ACCEL,
+	RAMP_CRUISE,
+	RAMP_DECEL,
+	/* Closed-loop only: the set-point reached the target, the PID holds the position */
+	RAMP_SETTLE
+}DcMotor_RampState;
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Motion profiles table in flash */
+static const DcMotor_ProfileType g_profiles[DC_MOTOR_NUM_OF_PROFILES] PROGMEM =
+{
+	/* accel_time, decel_time, travel_time, cruise_duty */
+	{ DC_MOTOR_DOOR_ACCEL_MS, DC_MOTOR_DOOR_DECEL_MS, DC_MOTOR_DOOR_TRAVEL_MS, DC_MOTOR_DOOR_CRUISE_DUTY },	/* DC_MOTOR_PROFILE_DOOR */
+	{ 1500, 1500, DC_MOTOR_DOOR_TRAVEL_MS, 204 },	/* DC_MOTOR_PROFILE_SOFT: 80% with long ramps */
+	{ 150 , 300 , DC_MOTOR_DOOR_TRAVEL_MS, 255 }	/* DC_MOTOR_PROFILE_FAST */
+};
+
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+/* Pins of the motor wired on the fixed L293D pins, it is attached at the initialization */
+static const DcMotor_PinsType g_defaultPins =
+{
+	L293D_IN1_PORT, L293D_IN1_PIN, L293D_IN2_PORT, L293D_IN2_PIN,
+	DC_MOTOR_CW_LIMIT_PORT_ID, DC_MOTOR_CW_LIMIT_PIN_ID, DC_MOTOR_ACW_LIMIT_PORT_ID, DC_MOTOR_ACW_LIMIT_PIN_ID
+};
+
+/* Pins of the attached channel, they are changed while no move is running only */
+static const DcMotor_PinsType *g_pins = &g_defaultPins ;
+#endif
+
+/* Ramp generator state, it is updated from the Timer0 overflow interrupt */
+static volatile DcMotor_RampState g_rampState = RAMP_IDLE ;
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+/* Position set-point trajectory in 16.16 fixed point, counts and counts per 1ms tick */
+static uint32 g_velocity ;
+static uint32 g_cruiseVelocity ;
+static uint32 g_accelVelocityStep ;
+static uint32 g_decelVelocityStep ;
+static uint32 g_travelled ;
+static uint32 g_moveDistance ;
+static uint32 g_decelStartDistance ;
+
+/* PID loop state, positions are in encoder counts */
+static sint16 g_startPosition ;
+static sint16 g_targetPosition ;
+static sint16 g_lastPosition ;
+static sint32 g_integral ;
+static uint8 g_settleTicks ;
+static uint16 g_moveOvershoot ;
+#else
+/* Current duty in 8.8 fixed point and the duty steps per 1ms tick */
+static uint16 g_rampDuty ;
+static uint16 g_cruiseDuty ;
+static uint16 g_accelStep ;
+static uint16 g_decelStep ;
+
+/* Time to start decelerating in ms */
+static uint16 g_decelStartTime ;
+#endif
+
+/* Elapsed time of the move and its safety timeout, in ms */
+static uint16 g_rampTime ;
+static uint16 g_travelTime ;
+
+/* Accumulator to generate exactly 1ms ticks on average from the PWM overflows */
+static uint16 g_tickAccumulator ;
+
+/* Direction of the running move and the reason of the last move end */
+static DcMotor_State g_moveDirection = MOTOR_OFF ;
+static volatile DcMotor_StopReason g_stopReason = DC_MOTOR_STOP_NONE ;
+static boolean g_stopRequested = FALSE ;
+
+static DcMotor_TravelStatsType g_travelStats ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for setting the motor direction pins and the PWM duty (0 → 255).
+ */
+static void DcMotor_drive(DcMotor_State state,uint8 duty);
+
+/*
+ * Function responsible for starting the 1ms tick of a new move and arming its limit switch.
+ */
+static void DcMotor_beginMove(DcMotor_State direction,uint16 travel_time);
+
+/*
+ * Timer0 overflow Call Back function, it runs the ramp generator every 1ms.
+ */
+static void DcMotor_rampTick(void);
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+/*
+ * Function responsible for the position set-point trajectory and the PID loop, called every 1ms.
+ */
+static void DcMotor_positionTick(void);
+
+/*
+ * Function responsible for calculating the 16.16 fixed point velocity step per 1ms.
+ */
+static uint32 DcMotor_velocityStep(uint32 velocity,uint16 time);
+#else
+/*
+ * Function responsible for the open-loop duty ramp, called every 1ms.
+ */
+static void DcMotor_dutyTick(void);
+
+/*
+ * Function responsible for calculating the 8.8 fixed point duty step per 1ms.
+ */
+static uint16 DcMotor_rampStep(uint16 duty_8_8,uint16 time);
+#endif
+
+/*
+ * Function responsible for stopping the motor at the end of the move and updating the travel statistics.
+ */
+static void DcMotor_endMove(DcMotor_StopReason reason);
+
+/*
+ * Function responsible for ending the running move on a request, the interrupts may end it too.
+ */
+static void DcMotor_cancelMove(void);
+
+#if(DC_MOTOR_STALL_DETECTION_ENABLE == TRUE)
+/*
+ * Current sensor Call Back function, it is called from the ADC interrupt on a stall.
+ */
+static void DcMotor_stalled(void);
+#endif
+
+#if(DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE)
+/*
+ * Function responsible for reading the limit switch at the end of the required direction.
+ */
+static uint8 DcMotor_readLimit(DcMotor_State direction);
+
+/*
+ * Function responsible for checking if the door is already at the end of the required direction.
+ */
+static boolean DcMotor_atLimit(DcMotor_State direction);
+
+#if(DC_MOTOR_LIMIT_POLLED == FALSE)
+/*
+ * External interrupt Call Back function of the armed limit switch.
+ */
+static void DcMotor_limitReached(void);
+
+/*
+ * Function responsible for returning the limit switch interrupt at the end of the required direction.
+ */
+static ExtInt_ID DcMotor_limitOf(DcMotor_State direction);
+#endif
+#endif
 
 /****************************************************************************
  * 							Functions Definitions						    *
@@ -23,13 +224,55 @@
  * Description:
  *	The Function responsible for setup the direction for the two motor pins through the GPIO driver.
  *	Stop at the DC-Motor at the beginning through the GPIO driver.
+ *	Initialize the PWM timer once, the speed changes only update the duty cycle later.
  */
 void DcMotor_Init(void)
 {
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+	/* Setup the direction and the limit switches pins of the default motor */
+	DcMotor_attach(&g_defaultPins);
+#else
 	GPIO_setupPinDirection(L293D_IN1_PORT, L293D_IN1_PIN, PIN_OUTPUT);
 	GPIO_setupPinDirection(L293D_IN2_PORT, L293D_IN2_PIN, PIN_OUTPUT);
+	GPIO_writePin(L293D_IN1_PORT, L293D_IN1_PIN, LOGIC_LOW);
+	GPIO_writePin(L293D_IN2_PORT, L293D_IN2_PIN, LOGIC_LOW);
+#endif
+
+	PWM_Timer0_ConfigType PWM_Timer0_ConfigStruct ;
+	PWM_Timer0_ConfigStruct.mode = DC_MOTOR_PWM_MODE ;
+	PWM_Timer0_ConfigStruct.prescaler = DC_MOTOR_PWM_PRESCALER ;
+	PWM_Timer0_ConfigStruct.initial_duty = 0 ;
+	PWM_Timer0_init(&PWM_Timer0_ConfigStruct);
+
+#if(DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE)
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+	/* The limit switches pins are setup by DcMotor_attach() */
+#elif(DC_MOTOR_LIMIT_POLLED == TRUE)
+	/* Setup the limit switches pins as inputs with the internal pull-up, they are polled by the tick */
+	GPIO_setupPinDirection(DC_MOTOR_CW_LIMIT_PORT_ID, DC_MOTOR_CW_LIMIT_PIN_ID, PIN_INPUT);
+	GPIO_writePin(DC_MOTOR_CW_LIMIT_PORT_ID, DC_MOTOR_CW_LIMIT_PIN_ID, LOGIC_HIGH);
+	GPIO_setupPinDirection(DC_MOTOR_ACW_LIMIT_PORT_ID, DC_MOTOR_ACW_LIMIT_PIN_ID, PIN_INPUT);
+	GPIO_writePin(DC_MOTOR_ACW_LIMIT_PORT_ID, DC_MOTOR_ACW_LIMIT_PIN_ID, LOGIC_HIGH);
+#else
+	/* Setup the limit switches pins, their interrupts are armed during the moves only */
+	ExtInt_ConfigType ExtInt_ConfigStruct ;
+	ExtInt_ConfigStruct.sense = ExtInt_Falling_Edge ;
+	ExtInt_ConfigStruct.pull_up = TRUE ;
+	ExtInt_ConfigStruct.id = DC_MOTOR_CW_LIMIT_INT_ID ;
+	ExtInt_init(&ExtInt_ConfigStruct);
+	ExtInt_deInit(DC_MOTOR_CW_LIMIT_INT_ID);
+	ExtInt_ConfigStruct.id = DC_MOTOR_ACW_LIMIT_INT_ID ;
+	ExtInt_init(&ExtInt_ConfigStruct);
+	ExtInt_deInit(DC_MOTOR_ACW_LIMIT_INT_ID);
+	ExtInt_setCallBack(DC_MOTOR_CW_LIMIT_INT_ID, DcMotor_limitReached);
+	ExtInt_setCallBack(DC_MOTOR_ACW_LIMIT_INT_ID, DcMotor_limitReached);
+#endif
+#endif
 
-	PWM_Timer0_Start(0);
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+	Encoder_init();
+	Encoder_setPosition(DC_MOTOR_CLOSED_POSITION);
+#endif
 }
 
 /* Inputs:
@@ -41,31 +284,732 @@ void DcMotor_Init(void)
  * Description:
  *	The function responsible for rotate the DC Motor CW/ or A-CW or stop the motor
  *	based on the state input state value.
- *	Send the required duty cycle to the PWM driver based on the required speed value.
+ *	Send the required duty cycle to the PWM driver based on the required speed value,
+ *	a speed above 100 is limited to 100.
  */
 void DcMotor_Rotate(DcMotor_State state,uint8 speed)
 {
-	float duty_cycle ;
+	/* Direct speed control cancels the running profile */
+	DcMotor_cancelMove();
+
+	/* The scaling does not saturate, a larger speed would wrap to a low duty */
+	if(speed > 100)
+	{
+		speed = 100 ;
+	}
+	DcMotor_drive(state, PWM_TIMER0_DUTY_FROM_PERCENT(speed));
+}
+
+/* Inputs:
+ * 	1. state   : The required DC Motor state, it should be CW or A-CW or stop.
+ * 	2. permille: The required motor speed in permille, it should be from 0 → 1000.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	The function responsible for rotate the DC Motor CW/ or A-CW or stop the motor
+ *	based on the state input state value.
+ *	The speed is scaled to the PWM duty by integer math, so no soft-float code is used.
+ *	A speed above 1000 is limited to 1000.
+ */
+void DcMotor_RotatePermille(DcMotor_State state,uint16 permille)
+{
+	DcMotor_cancelMove();
+
+	if(permille > 1000)
+	{
+		permille = 1000 ;
+	}
+	DcMotor_drive(state, PWM_TIMER0_DUTY_FROM_PERMILLE(permille));
+}
+
+/* Inputs:
+ * 	1. direction : The required DC Motor direction, it should be CW or A-CW.
+ * 	2. profile_id: The required motion profile from the flash profiles table.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start a trapezoidal move, the ramp generator runs from the Timer0 overflow interrupt
+ *	every 1ms and updates OCR0 along the acceleration, cruise and deceleration phases,
+ *	then the motor is stopped at the end of the profile travel time.
+ *	With the limit switches the motor is stopped once the limit of the direction is hit,
+ *	the move is not started if the door is already at that limit.
+ *	With the encoder CW is a closed-loop move to the open position and A-CW to the closed position.
+ */
+void DcMotor_startProfile(DcMotor_State direction,uint8 profile_id)
+{
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+	if(direction != MOTOR_OFF)
+	{
+		DcMotor_moveTo((direction == MOTOR_CW) ? DC_MOTOR_OPEN_POSITION : DC_MOTOR_CLOSED_POSITION, profile_id);
+	}
+#else
+	DcMotor_ProfileType profile ;
+
+	if((profile_id >= DC_MOTOR_NUM_OF_PROFILES) || (direction == MOTOR_OFF))
+	{
+		return ;
+	}
+
+	memcpy_P(&profile, &g_profiles[profile_id], sizeof(DcMotor_ProfileType));
+
+	DcMotor_cancelMove();
+
+#if(DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE)
+	if(DcMotor_atLimit(direction))
+	{
+		return ;
+	}
+#endif
+
+	/* The divisions are done once here, the tick only adds and subtracts */
+	g_cruiseDuty = ((uint16)profile.cruise_duty << 8) ;
+	g_accelStep = DcMotor_rampStep(g_cruiseDuty, profile.accel_time);
+	g_decelStep = DcMotor_rampStep(g_cruiseDuty, profile.decel_time);
+	g_decelStartTime = (profile.travel_time > profile.decel_time) ? (profile.travel_time - profile.decel_time) : 0 ;
+	g_rampDuty = 0 ;
+
+	DcMotor_drive(direction, 0);
+	DcMotor_beginMove(direction, profile.travel_time);
+#endif
+}
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+/* Inputs:
+ * 	1. target    : The required position in encoder counts.
+ * 	2. profile_id: The required motion profile from the flash profiles table.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start a closed-loop move, the profile generates the position set-point (trapezoidal speed)
+ *	and the PID loop follows it every 1ms until the position settles at the target.
+ */
+void DcMotor_moveTo(sint16 target,uint8 profile_id)
+{
+	DcMotor_ProfileType profile ;
+	DcMotor_State direction ;
+	sint16 position ;
+	uint16 distance ;
+	uint32 cruise_speed ;
+	uint32 accel_distance ;
+	uint32 decel_distance ;
+
+	if(profile_id >= DC_MOTOR_NUM_OF_PROFILES)
+	{
+		return ;
+	}
+
+	memcpy_P(&profile, &g_profiles[profile_id], sizeof(DcMotor_ProfileType));
+
+	DcMotor_cancelMove();
+
+	position = Encoder_getPosition();
+	if(target == position)
+	{
+		g_stopReason = DC_MOTOR_STOP_TARGET ;
+		return ;
+	}
+	direction = (target > position) ? MOTOR_CW : MOTOR_ACW ;
+	distance = (target > position) ? (uint16)(target - position) : (uint16)(position - target) ;
+
+#if(DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE)
+	if(DcMotor_atLimit(direction))
+	{
+		return ;
+	}
+#endif
+
+	/* Cruise speed in counts per second then per 1ms tick in 16.16 fixed point */
+	cruise_speed = ((uint32)profile.cruise_duty * DC_MOTOR_MAX_SPEED_CPS) / 255 ;
+	g_cruiseVelocity = (cruise_speed << 16) / 1000 ;
+	g_accelVelocityStep = DcMotor_velocityStep(g_cruiseVelocity, profile.accel_time);
+	g_decelVelocityStep = DcMotor_velocityStep(g_cruiseVelocity, profile.decel_time);
+
+	/*
+	 * The ramps cover (speed * time / 2) counts. A short move can not reach the cruise speed,
+	 * then it decelerates at the point splitting the distance in the ratio of the ramps times.
+	 */
+	accel_distance = (cruise_speed * profile.accel_time) / 2000 ;
+	decel_distance = (cruise_speed * profile.decel_time) / 2000 ;
+	if((accel_distance + decel_distance) <= distance)
+	{
+		g_decelStartDistance = (uint32)(distance - decel_distance) << 16 ;
+	}
+	else
+	{
+		g_decelStartDistance = (((uint32)distance * profile.accel_time) / ((uint32)profile.accel_time + profile.decel_time)) << 16 ;
+	}
+	g_moveDistance = (uint32)distance << 16 ;
+	g_velocity = 0 ;
+	g_travelled = 0 ;
+
+	g_startPosition = position ;
+	g_targetPosition = target ;
+	g_lastPosition = position ;
+	g_integral = 0 ;
+	g_settleTicks = 0 ;
+	g_moveOvershoot = 0 ;
+
+	DcMotor_beginMove(direction, profile.travel_time);
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The current door position in encoder counts.
+ *
+ * Description:
+ *	Read the door position measured by the encoder.
+ */
+sint16 DcMotor_getPosition(void)
+{
+	return Encoder_getPosition() ;
+}
+#endif
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start the deceleration of the running profile now (soft-stop).
+ */
+void DcMotor_stopProfile(void)
+{
+	uint8 sreg = SREG ;
+	cli();
+	if((g_rampState == RAMP_ACCEL) || (g_rampState == RAMP_CRUISE))
+	{
+		g_stopRequested = TRUE ;
+		g_rampState = RAMP_DECEL ;
+	}
+	SREG = sreg ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: TRUE while a profile is running.
+ *
+ * Description:
+ *	Check if the ramp generator is still moving the motor.
+ */
+boolean DcMotor_isMoving(void)
+{
+	return (g_rampState != RAMP_IDLE) ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The reason of the last move end.
+ *
+ * Description:
+ *	Check how the last profile ended, by the limit switch or by the safety timeout.
+ */
+DcMotor_StopReason DcMotor_getStopReason(void)
+{
+	return g_stopReason ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the travel statistics.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the measured travel times and the timeouts counters of both directions.
+ */
+void DcMotor_getTravelStats(DcMotor_TravelStatsType *stats)
+{
+	uint8 sreg = SREG ;
+	cli();
+	*stats = g_travelStats ;
+	SREG = sreg ;
+}
+
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+/* Inputs:
+ * 	1. Pointer to the pins of the required motor channel, it must stay valid while it is attached.
+ *
+ * Return Value: TRUE if the channel is attached, FALSE if a move is still running.
+ *
+ * Description:
+ *	Setup the direction and limit switches pins of the channel and select it for the next moves.
+ *	The travel statistics and the stop reason are shared by all the channels.
+ */
+boolean DcMotor_attach(const DcMotor_PinsType *pins)
+{
+	if(g_rampState != RAMP_IDLE)
+	{
+		return FALSE ;
+	}
+
+	GPIO_setupPinDirection(pins->in1_port, pins->in1_pin, PIN_OUTPUT);
+	GPIO_setupPinDirection(pins->in2_port, pins->in2_pin, PIN_OUTPUT);
+	GPIO_writePin(pins->in1_port, pins->in1_pin, LOGIC_LOW);
+	GPIO_writePin(pins->in2_port, pins->in2_pin, LOGIC_LOW);
+
+#if(DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE)
+	GPIO_setupPinDirection(pins->cw_limit_port, pins->cw_limit_pin, PIN_INPUT);
+	GPIO_writePin(pins->cw_limit_port, pins->cw_limit_pin, LOGIC_HIGH);
+	GPIO_setupPinDirection(pins->acw_limit_port, pins->acw_limit_pin, PIN_INPUT);
+	GPIO_writePin(pins->acw_limit_port, pins->acw_limit_pin, LOGIC_HIGH);
+#endif
+
+	g_pins = pins ;
+
+	return TRUE ;
+}
+#endif
+
+static void DcMotor_beginMove(DcMotor_State direction,uint16 travel_time)
+{
+	g_travelTime = travel_time ;
+	g_rampTime = 0 ;
+	g_tickAccumulator = 0 ;
+	g_moveDirection = direction ;
+	g_stopRequested = FALSE ;
+	g_stopReason = DC_MOTOR_STOP_NONE ;
+	g_rampState = RAMP_ACCEL ;
+
+	PWM_Timer0_setCallBack(DcMotor_rampTick);
+
+#if(DC_MOTOR_STALL_DETECTION_ENABLE == TRUE)
+	CurrentSensor_start(DcMotor_stalled);
+#endif
+
+#if((DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE) && (DC_MOTOR_LIMIT_POLLED == FALSE))
+	/* Arm the limit of this direction, ExtInt_init() clears its old pending flag */
+	ExtInt_ConfigType ExtInt_ConfigStruct ;
+	ExtInt_ConfigStruct.id = DcMotor_limitOf(direction) ;
+	ExtInt_ConfigStruct.sense = ExtInt_Falling_Edge ;
+	ExtInt_ConfigStruct.pull_up = TRUE ;
+	ExtInt_init(&ExtInt_ConfigStruct);
+
+	/* The limit may be hit before the interrupt is armed */
+	if(ExtInt_readPin(ExtInt_ConfigStruct.id) == DC_MOTOR_LIMIT_ACTIVE)
+	{
+		uint8 sreg = SREG ;
+		cli();
+		if(g_rampState != RAMP_IDLE)
+		{
+			DcMotor_endMove(DC_MOTOR_STOP_LIMIT);
+		}
+		SREG = sreg ;
+	}
+#endif
+}
+
+static void DcMotor_rampTick(void)
+{
+	/* One overflow every PWM period, generate a tick every 1ms on average */
+	g_tickAccumulator += 1000 ;
+	if(g_tickAccumulator < DC_MOTOR_PWM_FREQUENCY)
+	{
+		return ;
+	}
+	g_tickAccumulator -= DC_MOTOR_PWM_FREQUENCY ;
+
+	g_rampTime++ ;
+
+#if((DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE) && (DC_MOTOR_LIMIT_POLLED == TRUE))
+	if(DcMotor_readLimit(g_moveDirection) == DC_MOTOR_LIMIT_ACTIVE)
+	{
+		DcMotor_endMove(DC_MOTOR_STOP_LIMIT);
+		return ;
+	}
+#endif
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+	if(g_rampTime >= g_travelTime)
+	{
+		/* The safety timeout, the door did not reach the target */
+		DcMotor_endMove(DC_MOTOR_STOP_TIMEOUT);
+		return ;
+	}
+
+	DcMotor_positionTick();
+#else
+	DcMotor_dutyTick();
+#endif
+}
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+static void DcMotor_positionTick(void)
+{
+	sint16 position = Encoder_getPosition() ;
+	sint16 setpoint ;
+	sint16 error ;
+	sint16 overshoot ;
+	sint32 feedforward ;
+	sint32 output ;
+
+	/* Trapezoidal speed set-point, the decelerating set-point creeps at the last step until the target */
+	switch(g_rampState)
+	{
+	case RAMP_ACCEL :
+		if(g_travelled >= g_decelStartDistance)
+		{
+			g_rampState = RAMP_DECEL ;
+		}
+		else if((g_cruiseVelocity - g_velocity) > g_accelVelocityStep)
+		{
+			g_velocity += g_accelVelocityStep ;
+		}
+		else
+		{
+			g_velocity = g_cruiseVelocity ;
+			g_rampState = RAMP_CRUISE ;
+		}
+		break;
+	case RAMP_CRUISE :
+		if(g_travelled >= g_decelStartDistance)
+		{
+			g_rampState = RAMP_DECEL ;
+		}
+		break;
+	case RAMP_DECEL :
+		if(g_velocity > (2 * g_decelVelocityStep))
+		{
+			g_velocity -= g_decelVelocityStep ;
+		}
+		else if(g_stopRequested)
+		{
+			/* Soft-stop, hold the position where the set-point stops */
+			g_velocity = 0 ;
+			g_moveDistance = g_travelled ;
+		}
+		else
+		{
+			g_velocity = g_decelVelocityStep ;
+		}
+		break;
+	case RAMP_SETTLE :
+	case RAMP_IDLE :
+		break;
+	}
+
+	if(g_rampState != RAMP_SETTLE)
+	{
+		g_travelled += g_velocity ;
+		if(g_travelled >= g_moveDistance)
+		{
+			g_travelled = g_moveDistance ;
+			g_velocity = 0 ;
+			g_rampState = RAMP_SETTLE ;
+		}
+	}
+
+	setpoint = (sint16)(g_travelled >> 16) ;
+	setpoint = (g_moveDirection == MOTOR_CW) ? (g_startPosition + setpoint) : (g_startPosition - setpoint) ;
+	if((g_rampState == RAMP_SETTLE) && g_stopRequested)
+	{
+		g_targetPosition = setpoint ;
+	}
+
+	/* PID in 8.8 fixed point, the derivative acts on the measured position */
+	error = setpoint - position ;
+	output = ((sint32)DC_MOTOR_PID_KP * error)
+		   + ((sint32)DC_MOTOR_PID_KI * g_integral)
+		   - ((sint32)DC_MOTOR_PID_KD * (position - g_lastPosition)) ;
+
+	/* Velocity feed-forward, the PID corrects the error around the expected duty */
+	feedforward = (sint32)((g_velocity * DC_MOTOR_FF_GAIN) >> 8) ;
+	output += (g_moveDirection == MOTOR_CW) ? feedforward : -feedforward ;
+	output >>= 8 ;
+
+	/* Anti-windup: the error is not integrated while the output is saturated in its direction */
+	if(output > PWM_TIMER0_MAX_DUTY)
+	{
+		output = PWM_TIMER0_MAX_DUTY ;
+	}
+	else if(output < -PWM_TIMER0_MAX_DUTY)
+	{
+		output = -PWM_TIMER0_MAX_DUTY ;
+	}
+	if(!((output == PWM_TIMER0_MAX_DUTY) && (error > 0)) && !((output == -PWM_TIMER0_MAX_DUTY) && (error < 0)))
+	{
+		g_integral += error ;
+		if(g_integral > DC_MOTOR_PID_INTEGRAL_LIMIT)
+		{
+			g_integral = DC_MOTOR_PID_INTEGRAL_LIMIT ;
+		}
+		else if(g_integral < -DC_MOTOR_PID_INTEGRAL_LIMIT)
+		{
+			g_integral = -DC_MOTOR_PID_INTEGRAL_LIMIT ;
+		}
+	}
+	g_lastPosition = position ;
+
+	if(output >= 0)
+	{
+		DcMotor_drive(MOTOR_CW, (uint8)output);
+	}
+	else
+	{
+		DcMotor_drive(MOTOR_ACW, (uint8)(-output));
+	}
+
+	/* Overshoot past the target in the move direction */
+	overshoot = (g_moveDirection == MOTOR_CW) ? (position - g_targetPosition) : (g_targetPosition - position) ;
+	if((overshoot > 0) && ((uint16)overshoot > g_moveOvershoot))
+	{
+		g_moveOvershoot = (uint16)overshoot ;
+	}
+
+	if(g_rampState == RAMP_SETTLE)
+	{
+		error = g_targetPosition - position ;
+		if((error <= DC_MOTOR_POSITION_TOLERANCE) && (error >= -DC_MOTOR_POSITION_TOLERANCE))
+		{
+			g_settleTicks++ ;
+			if(g_settleTicks >= DC_MOTOR_SETTLE_TICKS)
+			{
+				DcMotor_endMove(g_stopRequested ? DC_MOTOR_STOP_REQUEST : DC_MOTOR_STOP_TARGET);
+			}
+		}
+		else
+		{
+			g_settleTicks = 0 ;
+		}
+	}
+}
+
+static uint32 DcMotor_velocityStep(uint32 velocity,uint16 time)
+{
+	uint32 step ;
+
+	if(time == 0)
+	{
+		/* No ramp, jump to the target speed on the first tick */
+		step = velocity ;
+	}
+	else
+	{
+		step = (velocity / time) ;
+		if(step == 0)
+		{
+			step = 1 ;
+		}
+	}
+
+	return step ;
+}
+#else
+static void DcMotor_dutyTick(void)
+{
+	if((g_rampState != RAMP_DECEL) && (g_rampTime >= g_decelStartTime))
+	{
+		g_rampState = RAMP_DECEL ;
+	}
+
+	switch(g_rampState)
+	{
+	case RAMP_ACCEL :
+		if((g_cruiseDuty - g_rampDuty) > g_accelStep)
+		{
+			g_rampDuty += g_accelStep ;
+		}
+		else
+		{
+			g_rampDuty = g_cruiseDuty ;
+			g_rampState = RAMP_CRUISE ;
+		}
+		break;
+	case RAMP_CRUISE :
+		break;
+	case RAMP_DECEL :
+		if(g_rampDuty > g_decelStep)
+		{
+			g_rampDuty -= g_decelStep ;
+		}
+		else
+		{
+			g_rampDuty = 0 ;
+		}
+		break;
+	case RAMP_SETTLE :
+	case RAMP_IDLE :
+		break;
+	}
+
+	if(((g_rampState == RAMP_DECEL) && (g_rampDuty == 0)) || (g_rampTime >= g_travelTime))
+	{
+		/* End of the move, before the limit switch when it is used */
+		DcMotor_endMove(g_stopRequested ? DC_MOTOR_STOP_REQUEST : DC_MOTOR_STOP_TIMEOUT);
+		return ;
+	}
+
+	PWM_Timer0_setDuty((uint8)(g_rampDuty >> 8));
+}
+
+static uint16 DcMotor_rampStep(uint16 duty_8_8,uint16 time)
+{
+	uint16 step ;
+
+	if(time == 0)
+	{
+		/* No ramp, jump to the target duty on the first tick */
+		step = duty_8_8 ;
+	}
+	else
+	{
+		step = (duty_8_8 / time) ;
+		if(step == 0)
+		{
+			step = 1 ;
+		}
+	}
+
+	return step ;
+}
+#endif
+
+static void DcMotor_endMove(DcMotor_StopReason reason)
+{
+	DcMotor_TravelType *travel = (g_moveDirection == MOTOR_CW) ? &g_travelStats.cw : &g_travelStats.acw ;
+
+	DcMotor_drive(MOTOR_OFF, 0);
+	PWM_Timer0_setCallBack(NULL_PTR);
+	g_rampState = RAMP_IDLE ;
+	g_stopReason = reason ;
+
+#if(DC_MOTOR_STALL_DETECTION_ENABLE == TRUE)
+	CurrentSensor_stop();
+#endif
+
+#if((DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE) && (DC_MOTOR_LIMIT_POLLED == FALSE))
+	ExtInt_deInit(DcMotor_limitOf(g_moveDirection));
+#endif
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+	if(reason == DC_MOTOR_STOP_LIMIT)
+	{
+		/* Home the position on the known end of travel */
+		Encoder_setPosition((g_moveDirection == MOTOR_CW) ? DC_MOTOR_OPEN_POSITION : DC_MOTOR_CLOSED_POSITION);
+	}
+	if(g_moveOvershoot > travel->max_overshoot)
+	{
+		travel->max_overshoot = g_moveOvershoot ;
+	}
+#endif
+
+	if((reason == DC_MOTOR_STOP_LIMIT) || (reason == DC_MOTOR_STOP_TARGET))
+	{
+		travel->last = g_rampTime ;
+		if((travel->moves == 0) || (g_rampTime < travel->min))
+		{
+			travel->min = g_rampTime ;
+		}
+		if(g_rampTime > travel->max)
+		{
+			travel->max = g_rampTime ;
+		}
+		if(travel->moves == 0)
+		{
+			travel->average = g_rampTime ;
+		}
+		else
+		{
+			travel->average = (uint16)((((uint32)travel->average * 7) + g_rampTime) >> 3) ;
+		}
+		travel->moves++ ;
+	}
+	else if(reason == DC_MOTOR_STOP_TIMEOUT)
+	{
+		travel->timeouts++ ;
+	}
+	else if(reason == DC_MOTOR_STOP_STALL)
+	{
+		travel->stalls++ ;
+	}
+}
+
+static void DcMotor_cancelMove(void)
+{
+	/* The limit switch, stall and ramp interrupts end the move too, it must be ended once */
+	uint8 sreg = SREG ;
+	cli();
+	if(g_rampState != RAMP_IDLE)
+	{
+		DcMotor_endMove(DC_MOTOR_STOP_REQUEST);
+	}
+	SREG = sreg ;
+}
+
+#if(DC_MOTOR_STALL_DETECTION_ENABLE == TRUE)
+static void DcMotor_stalled(void)
+{
+	if(g_rampState != RAMP_IDLE)
+	{
+		DcMotor_endMove(DC_MOTOR_STOP_STALL);
+	}
+}
+#endif
+
+#if(DC_MOTOR_LIMIT_SWITCHES_ENABLE == TRUE)
+static uint8 DcMotor_readLimit(DcMotor_State direction)
+{
+#if(DC_MOTOR_LIMIT_POLLED == TRUE)
+	if(direction == MOTOR_CW)
+	{
+		return GPIO_readPin(DC_MOTOR_CW_LIMIT_PORT, DC_MOTOR_CW_LIMIT_PIN) ;
+	}
+	return GPIO_readPin(DC_MOTOR_ACW_LIMIT_PORT, DC_MOTOR_ACW_LIMIT_PIN) ;
+#else
+	return ExtInt_readPin(DcMotor_limitOf(direction)) ;
+#endif
+}
+
+static boolean DcMotor_atLimit(DcMotor_State direction)
+{
+	if(DcMotor_readLimit(direction) != DC_MOTOR_LIMIT_ACTIVE)
+	{
+		return FALSE ;
+	}
+
+	/* The door is already at the end of this direction */
+	g_stopReason = DC_MOTOR_STOP_LIMIT ;
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+	Encoder_setPosition((direction == MOTOR_CW) ? DC_MOTOR_OPEN_POSITION : DC_MOTOR_CLOSED_POSITION);
+#endif
+	return TRUE ;
+}
+
+#if(DC_MOTOR_LIMIT_POLLED == FALSE)
+static void DcMotor_limitReached(void)
+{
+	if(g_rampState != RAMP_IDLE)
+	{
+		DcMotor_endMove(DC_MOTOR_STOP_LIMIT);
+	}
+}
+
+static ExtInt_ID DcMotor_limitOf(DcMotor_State direction)
+{
+	return (direction == MOTOR_CW) ? DC_MOTOR_CW_LIMIT_INT_ID : DC_MOTOR_ACW_LIMIT_INT_ID ;
+}
+#endif
+#endif
+
+static void DcMotor_drive(DcMotor_State state,uint8 duty)
+{
 	switch(state)
 	{
 	case MOTOR_OFF :
-		GPIO_writePin(L293D_IN1_PORT, L293D_IN1_PIN, LOGIC_LOW);
-		GPIO_writePin(L293D_IN2_PORT, L293D_IN2_PIN, LOGIC_LOW);
-		PWM_Timer0_Start(0);
+		GPIO_writePin(DC_MOTOR_IN1_PORT, DC_MOTOR_IN1_PIN, LOGIC_LOW);
+		GPIO_writePin(DC_MOTOR_IN2_PORT, DC_MOTOR_IN2_PIN, LOGIC_LOW);
+		PWM_Timer0_setDuty(0);
 		break;
 	case MOTOR_CW :
-		duty_cycle = ((float)speed/100) ;
-		GPIO_writePin(L293D_IN1_PORT, L293D_IN1_PIN, LOGIC_HIGH);
-		GPIO_writePin(L293D_IN2_PORT, L293D_IN2_PIN, LOGIC_LOW);
-		PWM_Timer0_Start(duty_cycle);
+		GPIO_writePin(DC_MOTOR_IN1_PORT, DC_MOTOR_IN1_PIN, LOGIC_HIGH);
+		GPIO_writePin(DC_MOTOR_IN2_PORT, DC_MOTOR_IN2_PIN, LOGIC_LOW);
+		PWM_Timer0_setDuty(duty);
 		break;
 	case MOTOR_ACW :
-		duty_cycle = ((float)speed/100) ;
-		GPIO_writePin(L293D_IN1_PORT, L293D_IN1_PIN, LOGIC_LOW);
-		GPIO_writePin(L293D_IN2_PORT, L293D_IN2_PIN, LOGIC_HIGH);
-		PWM_Timer0_Start(duty_cycle);
+		GPIO_writePin(DC_MOTOR_IN1_PORT, DC_MOTOR_IN1_PIN, LOGIC_LOW);
+		GPIO_writePin(DC_MOTOR_IN2_PORT, DC_MOTOR_IN2_PIN, LOGIC_HIGH);
+		PWM_Timer0_setDuty(duty);
 		break;
 	}
 }
-
-
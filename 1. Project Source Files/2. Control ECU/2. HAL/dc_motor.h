@@ -15,6 +15,7 @@
  ****************************************************************************/
 #include "gpio.h"
 #include "pwm_timer0.h"
+#include "external_interrupt.h"
 
 /****************************************************************************
  * 								 Definitions								*
@@ -25,6 +26,116 @@
 #define L293D_IN2_PORT 		PORTB_ID
 #define L293D_IN2_PIN 		PIN2_ID
 
+/* Motor PWM configurations: fast PWM with F_CPU/8 is 3.9KHz at 8MHz */
+#define DC_MOTOR_PWM_MODE 			PWM_Timer0_Fast_Mode
+#define DC_MOTOR_PWM_PRESCALER 		PWM_Timer0_F_CPU_8
+#define DC_MOTOR_PWM_FREQUENCY 		PWM_TIMER0_FAST_FREQUENCY(8)
+
+/*
+ * Motion profiles stored in flash, every profile accelerates from 0 to its cruise duty,
+ * cruises then decelerates to 0 before its travel time ends.
+ * The values are tuned per installation by the build flags (-DDC_MOTOR_DOOR_ACCEL_MS=...),
+ * times are in ms and the cruise duty is 0 → 255.
+ */
+#define DC_MOTOR_PROFILE_DOOR 		0
+#define DC_MOTOR_PROFILE_SOFT 		1
+#define DC_MOTOR_PROFILE_FAST 		2
+#define DC_MOTOR_NUM_OF_PROFILES 	3
+
+#ifndef DC_MOTOR_DOOR_ACCEL_MS
+#define DC_MOTOR_DOOR_ACCEL_MS 		400
+#endif
+#ifndef DC_MOTOR_DOOR_CRUISE_DUTY
+#define DC_MOTOR_DOOR_CRUISE_DUTY 	255
+#endif
+#ifndef DC_MOTOR_DOOR_DECEL_MS
+#define DC_MOTOR_DOOR_DECEL_MS 		600
+#endif
+#ifndef DC_MOTOR_DOOR_TRAVEL_MS
+#define DC_MOTOR_DOOR_TRAVEL_MS 	15000
+#endif
+
+/*
+ * End-of-travel limit switches (active low, internal pull-up). The CW move ends on the open
+ * limit and the A-CW move ends on the closed limit as soon as it is hit, the profile travel
+ * time is then only a safety timeout. Set to FALSE for the timing based positioning.
+ */
+#define DC_MOTOR_LIMIT_SWITCHES_ENABLE 	TRUE
+#define DC_MOTOR_CW_LIMIT_INT_ID 		ExtInt_INT0		/* PD2 */
+#define DC_MOTOR_ACW_LIMIT_INT_ID 		ExtInt_INT1		/* PD3 */
+#define DC_MOTOR_LIMIT_ACTIVE 			LOGIC_LOW
+
+/*
+ * Stall detection by the motor current (current_sensor.h), a stalled move is stopped by the
+ * ADC interrupt within a few milliseconds instead of running until the safety timeout.
+ * It needs the shunt amplifier on PA0, which is not on the board, a floating input would stop
+ * the moves at random.
+ */
+#define DC_MOTOR_STALL_DETECTION_ENABLE FALSE
+
+/*
+ * Several motors share the one PWM output (OC0 drives the enable input of every L293D), every
+ * motor has its own direction pins and limit switches and it is selected by DcMotor_attach()
+ * while no move is running, so one motor moves at a time. The external interrupts serve one
+ * motor only, so the limit switches are polled by the tick.
+ * The board has one motor, the second door of the Control ECU needs its L293D on PB4/PB5, its
+ * limit switches on PD4/PD5 and its own HMI panel on the RS-485 bus.
+ */
+#define DC_MOTOR_MULTI_CHANNEL_ENABLE 	FALSE
+
+/*
+ * Closed-loop position control with the quadrature encoder (encoder.h), the profile then
+ * generates a position set-point and a fixed-point PID loop drives OCR0 every 1ms tick.
+ * The encoder takes INT0/INT1, so the limit switches move to PD4/PD5 and are polled by the tick.
+ */
+#define DC_MOTOR_ENCODER_ENABLE 		FALSE
+
+#if((DC_MOTOR_ENCODER_ENABLE == TRUE) && (DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE))
+#error "The encoder position is tracked for one motor only, disable DC_MOTOR_MULTI_CHANNEL_ENABLE"
+#endif
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+#define DC_MOTOR_LIMIT_POLLED 			TRUE
+#define DC_MOTOR_CW_LIMIT_PORT_ID 		PORTD_ID
+#define DC_MOTOR_CW_LIMIT_PIN_ID 		PIN4_ID
+#define DC_MOTOR_ACW_LIMIT_PORT_ID 		PORTD_ID
+#define DC_MOTOR_ACW_LIMIT_PIN_ID 		PIN5_ID
+
+/* Door end positions in encoder counts, the door is locked at power up and re-homed on the limits */
+#define DC_MOTOR_CLOSED_POSITION 		0
+#define DC_MOTOR_OPEN_POSITION 			2400
+
+/* Encoder speed at full duty in counts per second, it scales the profile cruise speed */
+#define DC_MOTOR_MAX_SPEED_CPS 			3000
+
+/* Velocity feed-forward gain, duty per (count/ms) */
+#define DC_MOTOR_FF_GAIN 				((255UL * 1000UL) / DC_MOTOR_MAX_SPEED_CPS)
+
+/*
+ * PID gains in 8.8 fixed point, duty = Kp*error + Ki*sum(error) - Kd*(position change per tick).
+ * The derivative acts on the measured position so the set-point steps do not kick the output.
+ */
+#define DC_MOTOR_PID_KP 				1024	/* 4.0  */
+#define DC_MOTOR_PID_KI 				8		/* 0.03 */
+#define DC_MOTOR_PID_KD 				2560	/* 10.0 */
+
+/* Anti-windup clamp, the integral term alone can not exceed the full duty */
+#define DC_MOTOR_PID_INTEGRAL_LIMIT 	((sint32)((255L * 256L) / DC_MOTOR_PID_KI))
+
+/* The move ends when the position stays within the tolerance (counts) for the settle time (ms) */
+#define DC_MOTOR_POSITION_TOLERANCE 	4
+#define DC_MOTOR_SETTLE_TICKS 			50
+#elif(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+/* Limit switches of the default motor, the same pins of the interrupts but polled */
+#define DC_MOTOR_LIMIT_POLLED 			TRUE
+#define DC_MOTOR_CW_LIMIT_PORT_ID 		PORTD_ID
+#define DC_MOTOR_CW_LIMIT_PIN_ID 		PIN2_ID
+#define DC_MOTOR_ACW_LIMIT_PORT_ID 		PORTD_ID
+#define DC_MOTOR_ACW_LIMIT_PIN_ID 		PIN3_ID
+#else
+#define DC_MOTOR_LIMIT_POLLED 			FALSE
+#endif
+
 
 /****************************************************************************
  * 					          Types Declaration						        *
@@ -36,6 +147,95 @@ typedef enum
 	MOTOR_ACW
 }DcMotor_State;
 
+typedef struct
+{
+	/* Time to ramp from 0 to the cruise duty */
+	uint16 accel_time ;
+
+	/* Time to ramp from the cruise duty to 0 */
+	uint16 decel_time ;
+
+	/* Whole move time including the acceleration and the deceleration */
+	uint16 travel_time ;
+
+	/* PWM duty while cruising, 0 → 255 */
+	uint8 cruise_duty ;
+
+}DcMotor_ProfileType;
+
+/* The reason of the last move end */
+typedef enum
+{
+	DC_MOTOR_STOP_NONE,
+
+	/* The end-of-travel limit switch was hit */
+	DC_MOTOR_STOP_LIMIT,
+
+	/* The profile travel time ended before the limit switch */
+	DC_MOTOR_STOP_TIMEOUT,
+
+	/* The move was ended by DcMotor_stopProfile() */
+	DC_MOTOR_STOP_REQUEST,
+
+	/* The encoder position settled at the target */
+	DC_MOTOR_STOP_TARGET,
+
+	/* The motor current stayed above the stall threshold (door jammed) */
+	DC_MOTOR_STOP_STALL
+
+}DcMotor_StopReason;
+
+/* Measured travel times of one direction in ms, they are updated by the completed moves only */
+typedef struct
+{
+	uint16 last ;
+
+	uint16 min ;
+
+	uint16 max ;
+
+	/* Moving average with 1/8 weight for the last move */
+	uint16 average ;
+
+	uint16 moves ;
+
+	uint16 timeouts ;
+
+	uint16 stalls ;
+
+	/* Largest overshoot past the target in encoder counts (closed-loop moves only) */
+	uint16 max_overshoot ;
+
+}DcMotor_TravelType;
+
+/* Travel statistics for the trend monitoring of the door mechanism */
+typedef struct
+{
+	DcMotor_TravelType cw ;
+
+	DcMotor_TravelType acw ;
+
+}DcMotor_TravelStatsType;
+
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+/* Pins of one motor channel, the limit switches are active low with the internal pull-up */
+typedef struct
+{
+	uint8 in1_port ;
+	uint8 in1_pin ;
+
+	uint8 in2_port ;
+	uint8 in2_pin ;
+
+	uint8 cw_limit_port ;
+	uint8 cw_limit_pin ;
+
+	uint8 acw_limit_port ;
+	uint8 acw_limit_pin ;
+
+}DcMotor_PinsType;
+#endif
+
 /****************************************************************************
  * 							Functions Prototypes						    *
  ****************************************************************************/
@@ -47,6 +247,7 @@ typedef enum
  * Description:
  *	The Function responsible for setup the direction for the two motor pins through the GPIO driver.
  *	Stop at the DC-Motor at the beginning through the GPIO driver.
+ *	Initialize the PWM timer once, the speed changes only update the duty cycle later.
  */
 void DcMotor_Init(void);
 
@@ -59,9 +260,113 @@ void DcMotor_Init(void);
  * Description:
  *	The function responsible for rotate the DC Motor CW/ or A-CW or stop the motor
  *	based on the state input state value.
- *	Send the required duty cycle to the PWM driver based on the required speed value.
+ *	Send the required duty cycle to the PWM driver based on the required speed value,
+ *	a speed above 100 is limited to 100.
  */
 void DcMotor_Rotate(DcMotor_State state,uint8 speed);
 
+/* Inputs:
+ * 	1. state   : The required DC Motor state, it should be CW or A-CW or stop.
+ * 	2. permille: The required motor speed in permille, it should be from 0 → 1000.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	The function responsible for rotate the DC Motor CW/ or A-CW or stop the motor
+ *	based on the state input state value.
+ *	The speed is scaled to the PWM duty by integer math, so no soft-float code is used.
+ *	A speed above 1000 is limited to 1000.
+ */
+void DcMotor_RotatePermille(DcMotor_State state,uint16 permille);
+
+/* Inputs:
+ * 	1. direction : The required DC Motor direction, it should be CW or A-CW.
+ * 	2. profile_id: The required motion profile from the flash profiles table.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start a trapezoidal move, the ramp generator runs from the Timer0 overflow interrupt
+ *	every 1ms and updates OCR0 along the acceleration, cruise and deceleration phases,
+ *	then the motor is stopped at the end of the profile travel time.
+ *	With the limit switches the motor is stopped once the limit of the direction is hit,
+ *	the move is not started if the door is already at that limit.
+ *	With the encoder CW is a closed-loop move to the open position and A-CW to the closed position.
+ */
+void DcMotor_startProfile(DcMotor_State direction,uint8 profile_id);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start the deceleration of the running profile now (soft-stop).
+ */
+void DcMotor_stopProfile(void);
+
+/* Inputs: void.
+ *
+ * Return Value: TRUE while a profile is running.
+ *
+ * Description:
+ *	Check if the ramp generator is still moving the motor.
+ */
+boolean DcMotor_isMoving(void);
+
+#if(DC_MOTOR_ENCODER_ENABLE == TRUE)
+/* Inputs:
+ * 	1. target    : The required position in encoder counts.
+ * 	2. profile_id: The required motion profile from the flash profiles table.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start a closed-loop move, the profile generates the position set-point (trapezoidal speed)
+ *	and the PID loop follows it every 1ms until the position settles at the target.
+ */
+void DcMotor_moveTo(sint16 target,uint8 profile_id);
+
+/* Inputs: void.
+ *
+ * Return Value: The current door position in encoder counts.
+ *
+ * Description:
+ *	Read the door position measured by the encoder.
+ */
+sint16 DcMotor_getPosition(void);
+#endif
+
+/* Inputs: void.
+ *
+ * Return Value: The reason of the last move end.
+ *
+ * Description:
+ *	Check how the last profile ended, by the limit switch or by the safety timeout.
+ */
+DcMotor_StopReason DcMotor_getStopReason(void);
+
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the travel statistics.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the measured travel times and the timeouts counters of both directions.
+ */
+void DcMotor_getTravelStats(DcMotor_TravelStatsType *stats);
+
+#if(DC_MOTOR_MULTI_CHANNEL_ENABLE == TRUE)
+/* Inputs:
+ * 	1. Pointer to the pins of the required motor channel, it must stay valid while it is attached.
+ *
+ * Return Value: TRUE if the channel is attached, FALSE if a move is still running.
+ *
+ * Description:
+ *	Setup the direction and limit switches pins of the channel and select it for the next moves.
+ *	The travel statistics and the stop reason are shared by all the channels.
+ */
+boolean DcMotor_attach(const DcMotor_PinsType *pins);
+#endif
+
 
 #endif /* DC_MOTOR_H_ */
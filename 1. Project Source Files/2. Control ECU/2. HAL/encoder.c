@@ -0,0 +1,147 @@
+/*
+ ============================================================================
+ Name        : encoder.c
+ Author      : Ahmed Shawky
+ Description : Source File for Quadrature Encoder Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/interrupt.h>
+#include "encoder.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/* Marker of the invalid transitions in the quadrature table */
+#define ENCODER_INVALID 				2
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/*
+ * Quadrature decoding table, the index is (previous state << 2) | current state
+ * and the state is (B << 1) | A. The CW sequence is 0 → 1 → 3 → 2 → 0.
+ */
+static const sint8 g_quadratureTable[16] =
+{
+	 0, +1, -1, ENCODER_INVALID,
+	-1,  0, ENCODER_INVALID, +1,
+	+1, ENCODER_INVALID,  0, -1,
+	ENCODER_INVALID, -1, +1,  0
+};
+
+static volatile sint16 g_position = 0 ;
+static volatile uint16 g_errors = 0 ;
+static uint8 g_state ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * External interrupts Call Back function of both channels, it decodes one transition.
+ */
+static void Encoder_update(void);
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Setup the encoder channels as inputs with the internal pull-up and enable their
+ *	external interrupts on any logical change, the position starts from 0.
+ */
+void Encoder_init(void)
+{
+	ExtInt_ConfigType ExtInt_ConfigStruct ;
+
+	ExtInt_setCallBack(ENCODER_A_INT_ID, Encoder_update);
+	ExtInt_setCallBack(ENCODER_B_INT_ID, Encoder_update);
+
+	ExtInt_ConfigStruct.sense = ExtInt_Any_Change ;
+	ExtInt_ConfigStruct.pull_up = TRUE ;
+	ExtInt_ConfigStruct.id = ENCODER_A_INT_ID ;
+	ExtInt_init(&ExtInt_ConfigStruct);
+	ExtInt_ConfigStruct.id = ENCODER_B_INT_ID ;
+	ExtInt_init(&ExtInt_ConfigStruct);
+
+	g_state = ( ENCODER_PIN_REG >> ENCODER_A_PIN_ID ) & 0x03 ;
+	Encoder_setPosition(0);
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The current position in encoder counts.
+ *
+ * Description:
+ *	Read the position counted by the encoder interrupts.
+ */
+sint16 Encoder_getPosition(void)
+{
+	sint16 position ;
+	uint8 sreg = SREG ;
+	cli();
+	position = g_position ;
+	SREG = sreg ;
+	return position ;
+}
+
+/* Inputs:
+ * 	1. position: The new position in encoder counts.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Load the position counter, it is used to home the position on a known point.
+ */
+void Encoder_setPosition(sint16 position)
+{
+	uint8 sreg = SREG ;
+	cli();
+	g_position = position ;
+	SREG = sreg ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: Number of invalid transitions (both channels changed together).
+ *
+ * Description:
+ *	Read the number of lost steps, it grows when the encoder is faster than the interrupts.
+ */
+uint16 Encoder_getErrors(void)
+{
+	uint16 errors ;
+	uint8 sreg = SREG ;
+	cli();
+	errors = g_errors ;
+	SREG = sreg ;
+	return errors ;
+}
+
+static void Encoder_update(void)
+{
+	/* Both channels are read by one PIN access so they are sampled at the same time */
+	uint8 state = ( ENCODER_PIN_REG >> ENCODER_A_PIN_ID ) & 0x03 ;
+	sint8 step = g_quadratureTable[(g_state << 2) | state] ;
+
+	if(step == ENCODER_INVALID)
+	{
+		g_errors++ ;
+	}
+	else
+	{
+		g_position += step ;
+	}
+	g_state = state ;
+}
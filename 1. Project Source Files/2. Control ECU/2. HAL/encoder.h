@@ -0,0 +1,77 @@
+/*
+ ============================================================================
+ Name        : encoder.h
+ Author      : Ahmed Shawky
+ Description : Header File for Quadrature Encoder Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef ENCODER_H_
+#define ENCODER_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/io.h>
+#include "gpio.h"
+#include "external_interrupt.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * Encoder channels, both edges of both channels are counted (x4 decoding).
+ * The channels must be on consecutive pins of the same port (A then B),
+ * the position counts up while the motor turns CW, swap A and B otherwise.
+ */
+#define ENCODER_A_INT_ID 				ExtInt_INT0		/* PD2 */
+#define ENCODER_B_INT_ID 				ExtInt_INT1		/* PD3 */
+
+#define ENCODER_PIN_REG 				PIND
+#define ENCODER_A_PIN_ID 				PIN2_ID
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Setup the encoder channels as inputs with the internal pull-up and enable their
+ *	external interrupts on any logical change, the position starts from 0.
+ */
+void Encoder_init(void);
+
+/* Inputs: void.
+ *
+ * Return Value: The current position in encoder counts.
+ *
+ * Description:
+ *	Read the position counted by the encoder interrupts.
+ */
+sint16 Encoder_getPosition(void);
+
+/* Inputs:
+ * 	1. position: The new position in encoder counts.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Load the position counter, it is used to home the position on a known point.
+ */
+void Encoder_setPosition(sint16 position);
+
+/* Inputs: void.
+ *
+ * Return Value: Number of invalid transitions (both channels changed together).
+ *
+ * Description:
+ *	Read the number of lost steps, it grows when the encoder is faster than the interrupts.
+ */
+uint16 Encoder_getErrors(void);
+
+#endif /* ENCODER_H_ */
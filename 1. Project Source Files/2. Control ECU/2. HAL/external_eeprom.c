@@ -13,10 +13,183 @@
 #include "external_eeprom.h"
 #include "twi.h"
 
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/* The cache tags are the line numbers plus one, so the zero initialized tags are invalid */
+#define EEPROM_CACHE_TAG(line) 			((uint16)((line) + 1))
+#define EEPROM_CACHE_INVALID_TAG 		0
+
+#define EEPROM_QUEUE_LINE_SIZE 			EEPROM_PAGE_SIZE
+
+#if((EEPROM_QUEUE_ENABLE == TRUE) && (EEPROM_QUEUE_LINE_SIZE > 16))
+#error "The EEPROM queue dirty bytes mask has 16 bits"
+#endif
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+/* One queued line, the dirty bytes mask has bit n set if byte n of the line is to be written */
+typedef struct
+{
+	uint16 line ;
+
+	uint16 dirty ;
+
+	uint8 data[EEPROM_QUEUE_LINE_SIZE] ;
+
+}EEPROM_QueueLineType;
+#endif
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* One 24C16 until EEPROM_init is called, the memory of the older boards */
+static EEPROM_ConfigType g_config = {EEPROM_ONE_ADDRESS_BYTE, 11, 16, 1} ;
+
+static uint32 g_size = 2048 ;
+
+#if(EEPROM_CACHE_ENABLE == TRUE)
+static uint8 g_cacheData[EEPROM_CACHE_NUM_OF_LINES][EEPROM_CACHE_LINE_SIZE] ;
+static uint16 g_cacheTags[EEPROM_CACHE_NUM_OF_LINES] ;
+
+/* The line after the last filled lines, a miss on it is a sequential read */
+static uint16 g_cacheNextLine ;
+
+static EEPROM_CacheStatsType g_cacheStats ;
+#endif
+
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+/* Ring of the queued lines, they are written in the queuing order from the head */
+static EEPROM_QueueLineType g_queue[EEPROM_QUEUE_NUM_OF_LINES] ;
+static uint8 g_queueHead ;
+static uint8 g_queueCount ;
+#endif
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for getting the device address of a memory location, R/W=0 (write).
+ */
+static uint8 EEPROM_deviceAddress(uint32 u32addr);
+
+/*
+ * Function responsible for addressing the memory location for a write, it polls the device
+ * address until the EEPROM acknowledges, so it waits for the end of the last write cycle.
+ */
+static uint8 EEPROM_selectAddress(uint32 u32addr, uint8 polls);
+
+/*
+ * Function responsible for writing a block into the EEPROM device by page writes.
+ */
+static uint8 EEPROM_writeDevice(uint32 u32addr, const uint8 *data, uint16 size, uint8 polls);
+
+/*
+ * Function responsible for reading a block from the EEPROM device by sequential reads, the bytes
+ * are stored in the buffer or passed to the call back function if it is not NULL_PTR.
+ */
+static uint8 EEPROM_readDevice(uint32 u32addr, uint8 *data, uint16 size, void(*a_ptr)(uint8));
+
+#if(EEPROM_CACHE_ENABLE == TRUE)
+/*
+ * Function responsible for reading the missed line and the next lines of the block into the cache.
+ */
+static uint8 EEPROM_fillLines(uint16 line, uint16 size);
+
+/*
+ * Function responsible for invalidating the cached lines of a memory block.
+ */
+static void EEPROM_invalidateLines(uint32 u32addr, uint16 size);
+#endif
+
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+/*
+ * Function responsible for writing the first run of dirty bytes of the queue head line.
+ */
+static uint8 EEPROM_flushHead(uint8 polls);
+
+/*
+ * Function responsible for copying the queued bytes of a memory block over the read data.
+ */
+static void EEPROM_overlayQueue(uint32 u32addr, uint8 *data, uint16 size);
+#endif
+
 /****************************************************************************
  * 							Functions Definitions						    *
  ****************************************************************************/
 
+/* Inputs:
+ * 	1. Pointer to the memory configuration structure.
+ *
+ * Return Value: SUCCESS if the configuration is supported, ERROR otherwise.
+ *
+ * Description:
+ *	Select the addressing mode, page size and chips of the memory. The driver uses
+ *	one 24C16 until it is called.
+ */
+uint8 EEPROM_init(const EEPROM_ConfigType *Config_Ptr)
+{
+	uint32 size = (uint32)Config_Ptr->num_of_chips << Config_Ptr->chip_address_bits ;
+#if(EEPROM_CACHE_ENABLE == TRUE)
+	uint8 index ;
+#endif
+
+	/* The page size is a power of two, so the pages never cross a chip */
+	if((Config_Ptr->page_size < EEPROM_PAGE_SIZE) || ((Config_Ptr->page_size & (Config_Ptr->page_size - 1)) != 0))
+	{
+		return ERROR ;
+	}
+	if((Config_Ptr->num_of_chips == 0) || (Config_Ptr->num_of_chips > EEPROM_MAX_CHIPS))
+	{
+		return ERROR ;
+	}
+
+	if(Config_Ptr->addressing == EEPROM_ONE_ADDRESS_BYTE)
+	{
+		/* The block bits and the device-select pins share the 3 device address bits, 2KB at most */
+		if((Config_Ptr->chip_address_bits < 8) || (Config_Ptr->chip_address_bits > 11) || (size > 2048))
+		{
+			return ERROR ;
+		}
+	}
+	else if((Config_Ptr->chip_address_bits < 12) || (Config_Ptr->chip_address_bits > 16))
+	{
+		return ERROR ;
+	}
+
+	g_config = *Config_Ptr ;
+	g_size = size ;
+
+#if(EEPROM_CACHE_ENABLE == TRUE)
+	/* The cached lines belong to the older memory layout */
+	for(index = 0 ; index < EEPROM_CACHE_NUM_OF_LINES ; index++)
+	{
+		g_cacheTags[index] = EEPROM_CACHE_INVALID_TAG ;
+	}
+	g_cacheNextLine = 0 ;
+#endif
+
+	return SUCCESS ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The size of the memory bank in bytes.
+ *
+ * Description:
+ *	Get the size of all the configured chips.
+ */
+uint32 EEPROM_getSize(void)
+{
+	return g_size ;
+}
+
 /* Inputs:
  * 	1. The required data to be written into EEPROM memory.
  *
@@ -25,98 +198,669 @@
  * Description:
  *	Write data into EEPROM memory
  */
-uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data)
+uint8 EEPROM_writeByte(uint32 u32addr, uint8 u8data)
+{
+	return EEPROM_writeBlock(u32addr, &u8data, 1) ;
+}
+
+/* Inputs:
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read data from EEPROM memory.
+ */
+uint8 EEPROM_readByte(uint32 u32addr, uint8 *u8data)
+{
+	return EEPROM_readBlock(u32addr, u8data, 1) ;
+}
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into EEPROM memory.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Write a block into EEPROM memory by page writes, the block is split at the pages boundaries
+ *	so every page costs one write cycle.
+ */
+uint8 EEPROM_writeBlock(uint32 u32addr, const uint8 *data, uint16 size)
 {
-	/* Send the Start condition */
-	TWI_start();
-	if(TWI_getStatus() != TWI_START)
+	if((u32addr + size) > g_size)
 	{
 		return ERROR ;
 	}
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700) >> 7)));
-	if(TWI_getStatus() != TWI_MT_SLA_W_ACK)
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+	/* The queued writes go first, so the writes reach the EEPROM in the calls order */
+	if(EEPROM_sync() == ERROR)
 	{
 		return ERROR ;
 	}
+#endif
 
-	/* Send the required memory location address */
-	TWI_writeByte((uint8)(u16addr));
-	if(TWI_getStatus() != TWI_MT_DATA_ACK)
+	return EEPROM_writeDevice(u32addr, data, size, EEPROM_WRITE_CYCLE_POLLS) ;
+}
+
+/* Inputs:
+ * 	1. The address of the memory location.
+ * 	2. The required data to be written into EEPROM memory.
+ * 	3. Pointer to be filled with 1 if the byte was not written and 0 otherwise, it may be NULL_PTR.
+ *
+ * Return Value: The result of update operation.
+ *
+ * Description:
+ *	Write a byte only if it differs from the EEPROM byte.
+ */
+uint8 EEPROM_update(uint32 u32addr, uint8 u8data, uint16 *skipped)
+{
+	return EEPROM_updateBlock(u32addr, &u8data, 1, skipped) ;
+}
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into EEPROM memory.
+ * 	3. The number of bytes.
+ * 	4. Pointer to be filled with the number of bytes that were not written, it may be NULL_PTR.
+ *
+ * Return Value: The result of update operation.
+ *
+ * Description:
+ *	Write only the changed bytes of a block. The block is read and compared line by line and
+ *	every page gets one page write from its first to its last changed byte, so an unchanged
+ *	page costs no write cycle.
+ */
+uint8 EEPROM_updateBlock(uint32 u32addr, const uint8 *data, uint16 size, uint16 *skipped)
+{
+	uint8 line[EEPROM_PAGE_SIZE] ;
+	const uint8 *span_data = data ;
+	uint32 span_address = 0 ;
+	uint16 span_size = 0 ;
+	uint16 written = 0 ;
+	uint16 total = size ;
+	uint8 count ;
+	uint8 index ;
+
+	if((u32addr + size) > g_size)
 	{
 		return ERROR ;
 	}
 
-	/* write byte to EEPROM */
-	TWI_writeByte(u8data);
-	if(TWI_getStatus() != TWI_MT_DATA_ACK)
+	while(size != 0)
 	{
-		return ERROR ;
+		/* The bytes up to the end of the line, the lines never cross a page */
+		count = (uint8)(EEPROM_PAGE_SIZE - (u32addr & (EEPROM_PAGE_SIZE - 1))) ;
+		if(count > size)
+		{
+			count = (uint8)size ;
+		}
+
+		/* The read gets the cached and the queued bytes, so the block is compared with the latest data */
+		if(EEPROM_readBlock(u32addr, line, count) == ERROR)
+		{
+			return ERROR ;
+		}
+		for(index = 0 ; index < count ; index++)
+		{
+			if(line[index] != data[index])
+			{
+				if(span_size == 0)
+				{
+					span_address = u32addr + index ;
+					span_data = &data[index] ;
+				}
+				span_size = (uint16)((u32addr + index + 1) - span_address) ;
+			}
+		}
+		data += count ;
+		size -= count ;
+		u32addr += count ;
+
+		/* One write for the changed span at the end of every page, its unchanged bytes cost no extra write cycle */
+		if((span_size != 0) && (((u32addr & (g_config.page_size - 1)) == 0) || (size == 0)))
+		{
+			if(EEPROM_writeBlock(span_address, span_data, span_size) == ERROR)
+			{
+				return ERROR ;
+			}
+			written += span_size ;
+			span_size = 0 ;
+		}
 	}
 
-	/* Send the Stop condition */
-	TWI_stop();
+	if(skipped != NULL_PTR)
+	{
+		*skipped = total - written ;
+	}
 
 	return SUCCESS ;
 }
 
+#if(EEPROM_QUEUE_ENABLE == TRUE)
 /* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into EEPROM memory.
+ * 	3. The number of bytes.
+ *
+ * Return Value: SUCCESS if the block is queued, ERROR if it is out of the memory or a flush failed.
+ *
+ * Description:
+ *	Queue a block to be written by EEPROM_service, the reads return the queued data at once.
+ *	A write to the line at the queue tail is merged with it. If the queue is full the head
+ *	line is written first, it waits for the last write cycle.
+ */
+uint8 EEPROM_queueBlock(uint32 u32addr, const uint8 *data, uint16 size)
+{
+	EEPROM_QueueLineType *entry ;
+	uint16 line ;
+	uint8 offset ;
+
+	if((u32addr + size) > g_size)
+	{
+		return ERROR ;
+	}
+
+	while(size != 0)
+	{
+		line = (uint16)(u32addr / EEPROM_QUEUE_LINE_SIZE) ;
+		offset = (uint8)(u32addr % EEPROM_QUEUE_LINE_SIZE) ;
+
+		/* Only the tail line is merged, a merge with an older line would write it before the lines after it */
+		entry = &g_queue[(g_queueHead + g_queueCount - 1) % EEPROM_QUEUE_NUM_OF_LINES] ;
+		if((g_queueCount == 0) || (entry->line != line))
+		{
+			while(g_queueCount == EEPROM_QUEUE_NUM_OF_LINES)
+			{
+				if(EEPROM_flushHead(EEPROM_WRITE_CYCLE_POLLS) == ERROR)
+				{
+					return ERROR ;
+				}
+			}
+			entry = &g_queue[(g_queueHead + g_queueCount) % EEPROM_QUEUE_NUM_OF_LINES] ;
+			entry->line = line ;
+			entry->dirty = 0 ;
+			g_queueCount++ ;
+		}
+
+		while((size != 0) && (offset < EEPROM_QUEUE_LINE_SIZE))
+		{
+			entry->data[offset] = *data ;
+			SET_BIT(entry->dirty, offset);
+			data++ ;
+			offset++ ;
+			u32addr++ ;
+			size-- ;
+		}
+	}
+
+	return SUCCESS ;
+}
+
+/* Inputs: void.
  *
  * Return Value: void.
  *
  * Description:
- *	Read data from EEPROM memory.
+ *	Write the queue in the background, it is called from the main loop. It writes one page
+ *	if the EEPROM acknowledges at once, so it never waits for a write cycle.
+ */
+void EEPROM_service(void)
+{
+	if(g_queueCount != 0)
+	{
+		/* A busy EEPROM does not acknowledge, the line is written by a later call */
+		EEPROM_flushHead(1);
+	}
+}
+
+/* Inputs: void.
+ *
+ * Return Value: The result of the queued writes.
+ *
+ * Description:
+ *	Write all the queued lines and wait for the EEPROM, the data written before the call
+ *	is in the EEPROM when it returns SUCCESS.
+ */
+uint8 EEPROM_sync(void)
+{
+	while(g_queueCount != 0)
+	{
+		if(EEPROM_flushHead(EEPROM_WRITE_CYCLE_POLLS) == ERROR)
+		{
+			return ERROR ;
+		}
+	}
+
+	return SUCCESS ;
+}
+#endif
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the buffer to be filled with the data.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Read a block from EEPROM memory by one sequential read.
  */
-uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data)
+uint8 EEPROM_readBlock(uint32 u32addr, uint8 *data, uint16 size)
 {
-	/* Send the Start condition */
-	TWI_start();
-	if(TWI_getStatus() != TWI_START)
+#if(EEPROM_CACHE_ENABLE == TRUE)
+	uint16 line ;
+	uint8 slot ;
+	uint8 offset ;
+	uint8 count ;
+	uint8 index ;
+#endif
+
+	if((u32addr + size) > g_size)
 	{
 		return ERROR ;
 	}
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8)(0xA0 | ((u16addr & 0x0700) >> 7)));
-	if(TWI_getStatus() != TWI_MT_SLA_W_ACK)
+#if(EEPROM_CACHE_ENABLE == TRUE)
+	while(size != 0)
+	{
+		line = (uint16)(u32addr / EEPROM_CACHE_LINE_SIZE) ;
+		slot = (uint8)(line % EEPROM_CACHE_NUM_OF_LINES) ;
+		offset = (uint8)(u32addr % EEPROM_CACHE_LINE_SIZE) ;
+
+		if(g_cacheTags[slot] == EEPROM_CACHE_TAG(line))
+		{
+			g_cacheStats.hits++ ;
+		}
+		else
+		{
+			g_cacheStats.misses++ ;
+			if(EEPROM_fillLines(line, (size + offset)) == ERROR)
+			{
+				return ERROR ;
+			}
+		}
+
+		count = (uint8)(EEPROM_CACHE_LINE_SIZE - offset) ;
+		if(count > size)
+		{
+			count = (uint8)size ;
+		}
+		for(index = 0 ; index < count ; index++)
+		{
+			data[index] = g_cacheData[slot][offset + index] ;
+		}
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+		EEPROM_overlayQueue(u32addr, data, count);
+#endif
+		data += count ;
+		size -= count ;
+		u32addr += count ;
+	}
+#else
+	if(EEPROM_readDevice(u32addr, data, size, NULL_PTR) == ERROR)
 	{
 		return ERROR ;
 	}
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+	EEPROM_overlayQueue(u32addr, data, size);
+#endif
+#endif
 
-	/* Send the required memory location address */
-	TWI_writeByte((uint8)(u16addr));
-	if(TWI_getStatus() != TWI_MT_DATA_ACK)
+	return SUCCESS ;
+}
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. The number of bytes.
+ * 	3. Pointer to a Call Back function has a parameter uint8 and return void.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Read a block by one sequential read and pass every byte to the call back function, it is
+ *	not buffered so it streams blocks larger than the RAM. The queued writes are written first.
+ */
+uint8 EEPROM_readStream(uint32 u32addr, uint16 size, void(*a_ptr)(uint8))
+{
+	if((u32addr + size) > g_size)
 	{
 		return ERROR ;
 	}
 
-	/* Send the Start condition */
-	TWI_start();
-	if(TWI_getStatus() != TWI_REP_START)
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+	if(EEPROM_sync() == ERROR)
 	{
 		return ERROR ;
 	}
+#endif
+
+	return EEPROM_readDevice(u32addr, NULL_PTR, size, a_ptr) ;
+}
+
+#if(EEPROM_CACHE_ENABLE == TRUE)
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the cache counters.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the hits, misses and read-ahead counters of the EEPROM cache.
+ */
+void EEPROM_getCacheStats(EEPROM_CacheStatsType *stats)
+{
+	*stats = g_cacheStats ;
+}
+#endif
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=1 (read) */
-	TWI_writeByte((uint8)((0xA0 | ((u16addr & 0x0700) >> 7)) | 1));
-	if(TWI_getStatus() != TWI_MT_SLA_R_ACK)
+static uint8 EEPROM_deviceAddress(uint32 u32addr)
+{
+	if(g_config.addressing == EEPROM_ONE_ADDRESS_BYTE)
 	{
+		/* A8 A9 A10 of the bank address are the block bits of the chip and its device-select pins */
+		return (uint8)(EEPROM_DEVICE_BASE_ADDRESS | ((u32addr >> 7) & 0x0E)) ;
+	}
+
+	/* The chip number is on the device-select pins */
+	return (uint8)(EEPROM_DEVICE_BASE_ADDRESS | ((u32addr >> g_config.chip_address_bits) << 1)) ;
+}
+
+static uint8 EEPROM_selectAddress(uint32 u32addr, uint8 polls)
+{
+	uint8 retries = polls ;
+
+	while(1)
+	{
+		/* Send the Start condition */
+		TWI_start();
+		if((TWI_getStatus() != TWI_START) && (TWI_getStatus() != TWI_REP_START))
+		{
+			TWI_stop();
+			return ERROR ;
+		}
+
+		/* Send the device address of the memory location with R/W=0 (write) */
+		TWI_writeByte(EEPROM_deviceAddress(u32addr));
+		if(TWI_getStatus() == TWI_MT_SLA_W_ACK)
+		{
+			break ;
+		}
+
+		/* No acknowledge while the EEPROM is busy with the last write cycle */
+		retries-- ;
+		if(retries == 0)
+		{
+			TWI_stop();
+			return ERROR ;
+		}
+	}
+
+	/* Send the required memory location address, the high byte first on the two address bytes memories */
+	if(g_config.addressing == EEPROM_TWO_ADDRESS_BYTES)
+	{
+		TWI_writeByte((uint8)((u32addr & (((uint32)1 << g_config.chip_address_bits) - 1)) >> 8));
+		if(TWI_getStatus() != TWI_MT_DATA_ACK)
+		{
+			TWI_stop();
+			return ERROR ;
+		}
+	}
+	TWI_writeByte((uint8)(u32addr));
+	if(TWI_getStatus() != TWI_MT_DATA_ACK)
+	{
+		TWI_stop();
 		return ERROR ;
 	}
 
-	/* Read byte from EEPROM */
-	*u8data = TWI_readByteWithNACK();
-	if(TWI_getStatus() != TWI_MR_DATA_NACK)
+	return SUCCESS ;
+}
+
+static uint8 EEPROM_readDevice(uint32 u32addr, uint8 *data, uint16 size, void(*a_ptr)(uint8))
+{
+	uint8 byte ;
+	uint32 chip_size = (uint32)1 << g_config.chip_address_bits ;
+	uint16 count ;
+
+	while(size != 0)
+	{
+		/* The sequential read rolls over at the end of the chip, the next chip is read by a new read */
+		count = size ;
+		if(count > (chip_size - (u32addr & (chip_size - 1))))
+		{
+			count = (uint16)(chip_size - (u32addr & (chip_size - 1))) ;
+		}
+
+		if(EEPROM_selectAddress(u32addr, EEPROM_WRITE_CYCLE_POLLS) == ERROR)
+		{
+			return ERROR ;
+		}
+
+		/* Send the Start condition */
+		TWI_start();
+		if(TWI_getStatus() != TWI_REP_START)
+		{
+			TWI_stop();
+			return ERROR ;
+		}
+
+		/* Send the device address of the memory location with R/W=1 (read) */
+		TWI_writeByte((uint8)(EEPROM_deviceAddress(u32addr) | 1));
+		if(TWI_getStatus() != TWI_MT_SLA_R_ACK)
+		{
+			TWI_stop();
+			return ERROR ;
+		}
+
+		size -= count ;
+		u32addr += count ;
+
+		/* Read the bytes from EEPROM, the last byte is not acknowledged to end the read */
+		while(count > 1)
+		{
+			byte = TWI_readByteWithACK();
+			if(TWI_getStatus() != TWI_MR_DATA_ACK)
+			{
+				TWI_stop();
+				return ERROR ;
+			}
+			if(a_ptr != NULL_PTR)
+			{
+				(*a_ptr)(byte);
+			}
+			else
+			{
+				*data = byte ;
+				data++ ;
+			}
+			count-- ;
+		}
+		byte = TWI_readByteWithNACK();
+		if(TWI_getStatus() != TWI_MR_DATA_NACK)
+		{
+			TWI_stop();
+			return ERROR ;
+		}
+		if(a_ptr != NULL_PTR)
+		{
+			(*a_ptr)(byte);
+		}
+		else
+		{
+			*data = byte ;
+			data++ ;
+		}
+
+		/* Send the Stop condition */
+		TWI_stop();
+	}
+
+	return SUCCESS ;
+}
+
+#if(EEPROM_CACHE_ENABLE == TRUE)
+static uint8 EEPROM_fillLines(uint16 line, uint16 size)
+{
+	uint8 slot = (uint8)(line % EEPROM_CACHE_NUM_OF_LINES) ;
+	uint16 needed = (uint16)((size + (EEPROM_CACHE_LINE_SIZE - 1)) / EEPROM_CACHE_LINE_SIZE) ;
+	uint16 lines = needed ;
+	uint8 index ;
+
+	if(line == g_cacheNextLine)
+	{
+		lines += EEPROM_CACHE_READ_AHEAD_LINES ;
+	}
+
+	/* The lines are read into consecutive slots by one read, up to the last slot and the end of the memory */
+	if(lines > (EEPROM_CACHE_NUM_OF_LINES - slot))
+	{
+		lines = EEPROM_CACHE_NUM_OF_LINES - slot ;
+	}
+	if(lines > ((g_size / EEPROM_CACHE_LINE_SIZE) - line))
+	{
+		lines = (uint16)((g_size / EEPROM_CACHE_LINE_SIZE) - line) ;
+	}
+	if(lines > needed)
+	{
+		g_cacheStats.read_ahead += (lines - needed) ;
+	}
+
+	for(index = 0 ; index < lines ; index++)
+	{
+		g_cacheTags[slot + index] = EEPROM_CACHE_INVALID_TAG ;
+	}
+	if(EEPROM_readDevice(((uint32)line * EEPROM_CACHE_LINE_SIZE), g_cacheData[slot], (lines * EEPROM_CACHE_LINE_SIZE), NULL_PTR) == ERROR)
+	{
+		return ERROR ;
+	}
+	for(index = 0 ; index < lines ; index++)
+	{
+		g_cacheTags[slot + index] = EEPROM_CACHE_TAG(line + index) ;
+	}
+	g_cacheNextLine = (uint16)(line + lines) ;
+
+	return SUCCESS ;
+}
+
+static void EEPROM_invalidateLines(uint32 u32addr, uint16 size)
+{
+	uint16 line = (uint16)(u32addr / EEPROM_CACHE_LINE_SIZE) ;
+	uint16 last = (uint16)((u32addr + size) / EEPROM_CACHE_LINE_SIZE) ;
+	uint8 slot ;
+
+	while(line <= last)
+	{
+		slot = (uint8)(line % EEPROM_CACHE_NUM_OF_LINES) ;
+		if(g_cacheTags[slot] == EEPROM_CACHE_TAG(line))
+		{
+			g_cacheTags[slot] = EEPROM_CACHE_INVALID_TAG ;
+		}
+		line++ ;
+	}
+}
+#endif
+
+static uint8 EEPROM_writeDevice(uint32 u32addr, const uint8 *data, uint16 size, uint8 polls)
+{
+	uint8 count ;
+
+#if(EEPROM_CACHE_ENABLE == TRUE)
+	/* The lines are invalidated before the write, they are never newer than the EEPROM even if it fails */
+	EEPROM_invalidateLines(u32addr, size);
+#endif
+
+	while(size != 0)
+	{
+		/* Bytes left in the page of this address, the EEPROM address counter rolls over inside the page */
+		count = (uint8)(g_config.page_size - (u32addr & (g_config.page_size - 1))) ;
+		if(count > size)
+		{
+			count = (uint8)size ;
+		}
+
+		if(EEPROM_selectAddress(u32addr, polls) == ERROR)
+		{
+			return ERROR ;
+		}
+
+		size -= count ;
+		u32addr += count ;
+		while(count != 0)
+		{
+			/* write byte to EEPROM */
+			TWI_writeByte(*data);
+			if(TWI_getStatus() != TWI_MT_DATA_ACK)
+			{
+				TWI_stop();
+				return ERROR ;
+			}
+			data++ ;
+			count-- ;
+		}
+
+		/* Send the Stop condition, it starts the page write cycle */
+		TWI_stop();
+	}
+
+	return SUCCESS ;
+}
+
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+static uint8 EEPROM_flushHead(uint8 polls)
+{
+	EEPROM_QueueLineType *entry = &g_queue[g_queueHead] ;
+	uint8 first = 0 ;
+	uint8 last ;
+
+	/* The first run of dirty bytes, a line merged from separate writes may have clean bytes between them */
+	while(BIT_IS_CLEAR(entry->dirty, first))
+	{
+		first++ ;
+	}
+	last = first ;
+	while(((last + 1) < EEPROM_QUEUE_LINE_SIZE) && BIT_IS_SET(entry->dirty, (last + 1)))
+	{
+		last++ ;
+	}
+
+	if(EEPROM_writeDevice((((uint32)entry->line * EEPROM_QUEUE_LINE_SIZE) + first), &entry->data[first], (uint16)(last - first + 1), polls) == ERROR)
 	{
 		return ERROR ;
 	}
 
-	/* Send the Stop condition */
-	TWI_stop();
+	while(first <= last)
+	{
+		CLEAR_BIT(entry->dirty, first);
+		first++ ;
+	}
+	if(entry->dirty == 0)
+	{
+		g_queueHead = (g_queueHead + 1) % EEPROM_QUEUE_NUM_OF_LINES ;
+		g_queueCount-- ;
+	}
 
 	return SUCCESS ;
 }
+
+static void EEPROM_overlayQueue(uint32 u32addr, uint8 *data, uint16 size)
+{
+	EEPROM_QueueLineType *entry ;
+	uint32 address ;
+	uint8 count ;
+	uint8 index ;
+
+	/* From the head to the tail, so the newest queued byte wins */
+	for(count = 0 ; count < g_queueCount ; count++)
+	{
+		entry = &g_queue[(g_queueHead + count) % EEPROM_QUEUE_NUM_OF_LINES] ;
+		address = (uint32)entry->line * EEPROM_QUEUE_LINE_SIZE ;
+		for(index = 0 ; index < EEPROM_QUEUE_LINE_SIZE ; index++)
+		{
+			if(BIT_IS_SET(entry->dirty, index) && ((address + index) >= u32addr) && ((address + index) < (u32addr + size)))
+			{
+				data[(address + index) - u32addr] = entry->data[index] ;
+			}
+		}
+	}
+}
+#endif
@@ -22,10 +22,110 @@
 #define ERROR 		0
 #define SUCCESS 	1
 
+/*
+ * The smallest page of the supported memories, the drivers above lay out their records in pages of
+ * this size so they work on all of them. The configured page size must be a multiple of it.
+ */
+#define EEPROM_PAGE_SIZE 				16
+
+/* The 24Cxx device address, the device-select pins A2 A1 A0 are in bits 3:1 */
+#define EEPROM_DEVICE_BASE_ADDRESS 		0xA0
+#define EEPROM_MAX_CHIPS 				8
+
+/*
+ * Device address polls while the EEPROM finishes the last write cycle (5ms max),
+ * one poll takes about 25us at 400Kbps.
+ */
+#define EEPROM_WRITE_CYCLE_POLLS 		255
+
+/*
+ * Direct-mapped read cache of EEPROM_PAGE_SIZE lines in SRAM. A miss right after the last filled
+ * line reads the next line too by the same sequential read. The writes invalidate their lines.
+ */
+#define EEPROM_CACHE_ENABLE 			TRUE
+#define EEPROM_CACHE_NUM_OF_LINES 		4
+#define EEPROM_CACHE_LINE_SIZE 			EEPROM_PAGE_SIZE
+#define EEPROM_CACHE_READ_AHEAD_LINES 	1
+
+/*
+ * Write-behind queue of EEPROM_PAGE_SIZE lines, EEPROM_queueBlock returns at once and
+ * EEPROM_service writes the lines in the background without waiting for the write cycles.
+ */
+#define EEPROM_QUEUE_ENABLE 			TRUE
+#define EEPROM_QUEUE_NUM_OF_LINES 		4
+
+#if((EEPROM_CACHE_ENABLE == TRUE) && (EEPROM_CACHE_READ_AHEAD_LINES >= EEPROM_CACHE_NUM_OF_LINES))
+#error "The EEPROM cache read-ahead must leave a line for the missed line"
+#endif
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef enum
+{
+	/* 24C01 → 24C16: one address byte, the address bits above A7 are sent in the device address */
+	EEPROM_ONE_ADDRESS_BYTE,
+
+	/* 24C32 → 24C512: two address bytes, the device address selects the chip only */
+	EEPROM_TWO_ADDRESS_BYTES
+
+}EEPROM_AddressingType;
+
+typedef struct
+{
+	EEPROM_AddressingType addressing ;
+
+	/* Address bits of one chip: 11 for 24C16, 12 for 24C32 up to 16 for 24C512 */
+	uint8 chip_address_bits ;
+
+	/* Page size of the chip: 16 for 24C16, 32 for 24C32/64, 64 for 24C128/256 and 128 for 24C512 */
+	uint8 page_size ;
+
+	/*
+	 * Chips on the bus, their device-select pins are wired from 0 up. The chips are one bank,
+	 * chip n holds the addresses from (n << chip_address_bits).
+	 */
+	uint8 num_of_chips ;
+
+}EEPROM_ConfigType;
+
+/* EEPROM cache instrumentation counters, the lines accesses of the reads */
+typedef struct
+{
+	uint16 hits ;
+
+	uint16 misses ;
+
+	/* Lines read ahead of the missed lines */
+	uint16 read_ahead ;
+
+}EEPROM_CacheStatsType;
+
 /****************************************************************************
  * 							Functions Prototypes						    *
  ****************************************************************************/
 
+/* Inputs:
+ * 	1. Pointer to the memory configuration structure.
+ *
+ * Return Value: SUCCESS if the configuration is supported, ERROR otherwise.
+ *
+ * Description:
+ *	Select the addressing mode, page size and chips of the memory. The driver uses
+ *	one 24C16 until it is called.
+ */
+uint8 EEPROM_init(const EEPROM_ConfigType *Config_Ptr);
+
+/* Inputs: void.
+ *
+ * Return Value: The size of the memory bank in bytes.
+ *
+ * Description:
+ *	Get the size of all the configured chips.
+ */
+uint32 EEPROM_getSize(void);
+
 /* Inputs:
  * 	1.
  * 	2. The required data to be written into EEPROM memory.
@@ -35,7 +135,7 @@
  * Description:
  *	Write data into EEPROM memory
  */
-uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data);
+uint8 EEPROM_writeByte(uint32 u32addr, uint8 u8data);
 
 /* Inputs:
  *
@@ -44,7 +144,121 @@ uint8 EEPROM_writeByte(uint16 u16addr, uint8 u8data);
  * Description:
  *	Read data from EEPROM memory.
  */
-uint8 EEPROM_readByte(uint16 u16addr, uint8 *u8data);
+uint8 EEPROM_readByte(uint32 u32addr, uint8 *u8data);
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into EEPROM memory.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Write a block into EEPROM memory by page writes, the block is split at the pages boundaries
+ *	so every page costs one write cycle. The queued writes are written before it.
+ */
+uint8 EEPROM_writeBlock(uint32 u32addr, const uint8 *data, uint16 size);
+
+/* Inputs:
+ * 	1. The address of the memory location.
+ * 	2. The required data to be written into EEPROM memory.
+ * 	3. Pointer to be filled with 1 if the byte was not written and 0 otherwise, it may be NULL_PTR.
+ *
+ * Return Value: The result of update operation.
+ *
+ * Description:
+ *	Write a byte only if it differs from the EEPROM byte.
+ */
+uint8 EEPROM_update(uint32 u32addr, uint8 u8data, uint16 *skipped);
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into EEPROM memory.
+ * 	3. The number of bytes.
+ * 	4. Pointer to be filled with the number of bytes that were not written, it may be NULL_PTR.
+ *
+ * Return Value: The result of update operation.
+ *
+ * Description:
+ *	Write only the changed bytes of a block. The block is read and compared line by line and
+ *	every page gets one page write from its first to its last changed byte, so an unchanged
+ *	page costs no write cycle.
+ */
+uint8 EEPROM_updateBlock(uint32 u32addr, const uint8 *data, uint16 size, uint16 *skipped);
+
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into EEPROM memory.
+ * 	3. The number of bytes.
+ *
+ * Return Value: SUCCESS if the block is queued, ERROR if it is out of the memory or a flush failed.
+ *
+ * Description:
+ *	Queue a block to be written by EEPROM_service, the reads return the queued data at once.
+ *	A write to the line at the queue tail is merged with it. If the queue is full the head
+ *	line is written first, it waits for the last write cycle.
+ */
+uint8 EEPROM_queueBlock(uint32 u32addr, const uint8 *data, uint16 size);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Write the queue in the background, it is called from the main loop. It writes one page
+ *	if the EEPROM acknowledges at once, so it never waits for a write cycle.
+ */
+void EEPROM_service(void);
+
+/* Inputs: void.
+ *
+ * Return Value: The result of the queued writes.
+ *
+ * Description:
+ *	Write all the queued lines and wait for the EEPROM, the data written before the call
+ *	is in the EEPROM when it returns SUCCESS.
+ */
+uint8 EEPROM_sync(void);
+#endif
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the buffer to be filled with the data.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Read a block from EEPROM memory, the cached lines are copied from SRAM and the missed
+ *	lines are read by one sequential read.
+ */
+uint8 EEPROM_readBlock(uint32 u32addr, uint8 *data, uint16 size);
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. The number of bytes.
+ * 	3. Pointer to a Call Back function has a parameter uint8 and return void.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Read a block by one sequential read and pass every byte to the call back function, it is
+ *	not buffered so it streams blocks larger than the RAM. The queued writes are written first.
+ */
+uint8 EEPROM_readStream(uint32 u32addr, uint16 size, void(*a_ptr)(uint8));
+
+#if(EEPROM_CACHE_ENABLE == TRUE)
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the cache counters.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the hits, misses and read-ahead counters of the EEPROM cache.
+ */
+void EEPROM_getCacheStats(EEPROM_CacheStatsType *stats);
+#endif
 
 
 
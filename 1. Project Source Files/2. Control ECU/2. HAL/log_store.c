@@ -0,0 +1,398 @@
+/*
+ ============================================================================
+ Name        : log_store.c
+ Author      : Ahmed Shawky
+ Description : Source File for Log-Structured Record Store Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <util/crc16.h>
+#include "log_store.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * The sequence numbers are 15-bit and they count the appends, so the pages after the oldest
+ * record hold consecutive numbers. An erased page reads 0xFFFF, so the MSB marks no record.
+ */
+#define LOG_STORE_SEQUENCE_MASK 		0x7FFF
+#define LOG_STORE_SEQUENCE_INVALID 		0x8000
+
+#define LOG_STORE_NO_PAGE 				0xFF
+#define LOG_STORE_NO_KEY 				0xFF
+
+#define LOG_STORE_PAGE_ADDRESS(page) 	(LOG_STORE_START_ADDRESS + ((uint16)(page) * LOG_STORE_RECORD_SIZE))
+#define LOG_STORE_NEXT_PAGE(page) 		((uint8)(((page) + 1) < LOG_STORE_NUM_OF_PAGES ? ((page) + 1) : 0))
+#define LOG_STORE_PREVIOUS_PAGE(page) 	((uint8)((page) != 0 ? ((page) - 1) : (LOG_STORE_NUM_OF_PAGES - 1)))
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+/* One record, it is one EEPROM page */
+typedef struct
+{
+	uint16 sequence ;
+
+	uint8 key ;
+
+	uint8 length ;
+
+	uint8 data[LOG_STORE_DATA_SIZE] ;
+
+	/* CRC-CCITT of all the record bytes before it */
+	uint16 crc ;
+
+}LogStore_RecordType;
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Page and sequence number of the latest record, the next record goes to the next page */
+static uint8 g_headPage = LOG_STORE_NO_PAGE ;
+static uint16 g_headSequence ;
+
+/* Page of the latest record of every key */
+static uint8 g_keyPages[LOG_STORE_NUM_OF_KEYS] ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for calculating the CRC of a record.
+ */
+static uint16 LogStore_crc(const LogStore_RecordType *record);
+
+/*
+ * Function responsible for checking the sequence number, the fields and the CRC of a record.
+ */
+static boolean LogStore_isValid(const LogStore_RecordType *record);
+
+/*
+ * Function responsible for reading the record of a page, it returns FALSE for an erased or a corrupted page.
+ */
+static boolean LogStore_readRecord(uint8 page,LogStore_RecordType *record);
+
+/*
+ * Function responsible for appending a record to the next page and indexing it.
+ */
+static uint8 LogStore_append(uint8 key,const uint8 *data,uint8 size);
+
+/*
+ * Function responsible for returning the key of the live record in a page, LOG_STORE_NO_KEY if it is obsolete.
+ */
+static uint8 LogStore_liveKey(uint8 page);
+
+/*
+ * Function responsible for copying the live record of a page forward to the next page.
+ */
+static uint8 LogStore_compact(uint8 page);
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Find the latest record by a binary search over the pages sequence numbers, then index the
+ *	latest valid record of every key in RAM. The TWI driver must be initialized before.
+ */
+void LogStore_init(void)
+{
+	LogStore_RecordType record ;
+	uint16 reference_sequence ;
+	uint16 sequence ;
+	uint8 reference ;
+	uint8 low ;
+	uint8 high ;
+	uint8 middle ;
+	uint8 page ;
+	uint8 count ;
+
+	g_headPage = LOG_STORE_NO_PAGE ;
+	for(count = 0 ; count < LOG_STORE_NUM_OF_KEYS ; count++)
+	{
+		g_keyPages[count] = LOG_STORE_NO_PAGE ;
+	}
+
+	/* The reference is the first valid page, it is page 0 unless page 0 was never written or torn */
+	for(reference = 0 ; reference < LOG_STORE_NUM_OF_PAGES ; reference++)
+	{
+		if(LogStore_readRecord(reference, &record))
+		{
+			break ;
+		}
+	}
+	if(reference == LOG_STORE_NUM_OF_PAGES)
+	{
+		/* Empty store, the first record goes to page 0 */
+		g_headPage = LOG_STORE_NUM_OF_PAGES - 1 ;
+		g_headSequence = LOG_STORE_SEQUENCE_MASK ;
+		return ;
+	}
+	reference_sequence = record.sequence ;
+
+	/*
+	 * The pages from the reference up to the latest record hold consecutive sequence numbers and
+	 * the pages after it hold older (or no) records, so the latest record is the last page of the run.
+	 * Only the sequence number of the probed pages is read.
+	 */
+	low = reference ;
+	high = LOG_STORE_NUM_OF_PAGES - 1 ;
+	while(low < high)
+	{
+		middle = (uint8)((low + high + 1) / 2) ;
+		if((LOG_STORE_STORAGE.readBlock(LOG_STORE_PAGE_ADDRESS(middle), (uint8*)&sequence, sizeof(sequence)) == SUCCESS)
+		&& ((sequence & LOG_STORE_SEQUENCE_INVALID) == 0)
+		&& (((sequence - reference_sequence) & LOG_STORE_SEQUENCE_MASK) == (uint16)(middle - reference)))
+		{
+			low = middle ;
+		}
+		else
+		{
+			high = (uint8)(middle - 1) ;
+		}
+	}
+
+	/* A torn append has a good sequence number only, step back to the last complete record */
+	page = low ;
+	for(count = 0 ; count < LOG_STORE_NUM_OF_PAGES ; count++)
+	{
+		if(LogStore_readRecord(page, &record))
+		{
+			break ;
+		}
+		page = LOG_STORE_PREVIOUS_PAGE(page) ;
+	}
+	g_headPage = page ;
+	g_headSequence = record.sequence ;
+
+	/* Index the keys from the latest record backward, the first record of a key is its latest one */
+	for(count = 0 ; count < LOG_STORE_NUM_OF_PAGES ; count++)
+	{
+		if(LogStore_readRecord(page, &record) && (g_keyPages[record.key] == LOG_STORE_NO_PAGE))
+		{
+			g_keyPages[record.key] = page ;
+		}
+		page = LOG_STORE_PREVIOUS_PAGE(page) ;
+	}
+}
+
+/* Inputs:
+ * 	1. key : The record key, it should be from 0 → (LOG_STORE_NUM_OF_KEYS - 1).
+ * 	2. Pointer to the record data.
+ * 	3. size: The number of data bytes, it should be from 1 → LOG_STORE_DATA_SIZE.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Append a new version of the key record to the next page, the older versions become obsolete.
+ */
+uint8 LogStore_write(uint8 key, const uint8 *data, uint8 size)
+{
+	uint8 page ;
+	uint8 live_key ;
+
+	if((key >= LOG_STORE_NUM_OF_KEYS) || (size == 0) || (size > LOG_STORE_DATA_SIZE) || (g_headPage == LOG_STORE_NO_PAGE))
+	{
+		return ERROR ;
+	}
+
+	/* The next page is always obsolete, a live record is found there after a corrupted log only */
+	page = LOG_STORE_NEXT_PAGE(g_headPage) ;
+	live_key = LogStore_liveKey(page) ;
+	if((live_key != LOG_STORE_NO_KEY) && (live_key != key) && (LogStore_compact(page) == ERROR))
+	{
+		return ERROR ;
+	}
+
+	/*
+	 * The page after the next one becomes the next page after this append, so its live record is
+	 * copied to the next page first. It is normally done already by the background compaction.
+	 */
+	page = LOG_STORE_NEXT_PAGE(LOG_STORE_NEXT_PAGE(g_headPage)) ;
+	live_key = LogStore_liveKey(page) ;
+	while((live_key != LOG_STORE_NO_KEY) && (live_key != key))
+	{
+		if(LogStore_compact(page) == ERROR)
+		{
+			return ERROR ;
+		}
+		page = LOG_STORE_NEXT_PAGE(LOG_STORE_NEXT_PAGE(g_headPage)) ;
+		live_key = LogStore_liveKey(page) ;
+	}
+
+	return LogStore_append(key, data, size) ;
+}
+
+/* Inputs:
+ * 	1. key : The record key, it should be from 0 → (LOG_STORE_NUM_OF_KEYS - 1).
+ * 	2. Pointer to the buffer to be filled with the record data.
+ * 	3. size: The size of the buffer.
+ *
+ * Return Value: SUCCESS if the key has a valid record, ERROR otherwise.
+ *
+ * Description:
+ *	Read the latest record of the key by one block read.
+ */
+uint8 LogStore_read(uint8 key, uint8 *data, uint8 size)
+{
+	LogStore_RecordType record ;
+	uint8 index ;
+
+	if((key >= LOG_STORE_NUM_OF_KEYS) || (g_keyPages[key] == LOG_STORE_NO_PAGE))
+	{
+		return ERROR ;
+	}
+
+	if(!LogStore_readRecord(g_keyPages[key], &record) || (record.key != key))
+	{
+		return ERROR ;
+	}
+
+	for(index = 0 ; (index < size) && (index < record.length) ; index++)
+	{
+		data[index] = record.data[index] ;
+	}
+
+	return SUCCESS ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Background compaction, it is called from the main loop. A live record two pages after the
+ *	latest record is copied forward before it is reached, so an update costs one page write.
+ */
+void LogStore_service(void)
+{
+	uint8 page ;
+
+	if(g_headPage == LOG_STORE_NO_PAGE)
+	{
+		return ;
+	}
+
+	/* One copy per call, the page after the next one is the next page after the coming append */
+	page = LOG_STORE_NEXT_PAGE(LOG_STORE_NEXT_PAGE(g_headPage)) ;
+	if(LogStore_liveKey(page) != LOG_STORE_NO_KEY)
+	{
+		LogStore_compact(page);
+	}
+}
+
+static uint16 LogStore_crc(const LogStore_RecordType *record)
+{
+	const uint8 *bytes = (const uint8*)record ;
+	uint16 crc = 0xFFFF ;
+	uint8 index ;
+
+	for(index = 0 ; index < (uint8)(sizeof(LogStore_RecordType) - sizeof(record->crc)) ; index++)
+	{
+		crc = _crc_ccitt_update(crc, bytes[index]);
+	}
+
+	return crc ;
+}
+
+static boolean LogStore_isValid(const LogStore_RecordType *record)
+{
+	return (((record->sequence & LOG_STORE_SEQUENCE_INVALID) == 0)
+		 && (record->key < LOG_STORE_NUM_OF_KEYS)
+		 && (record->length <= LOG_STORE_DATA_SIZE)
+		 && (record->crc == LogStore_crc(record))) ;
+}
+
+static boolean LogStore_readRecord(uint8 page,LogStore_RecordType *record)
+{
+	if(LOG_STORE_STORAGE.readBlock(LOG_STORE_PAGE_ADDRESS(page), (uint8*)record, sizeof(LogStore_RecordType)) == ERROR)
+	{
+		return FALSE ;
+	}
+
+	return LogStore_isValid(record) ;
+}
+
+static uint8 LogStore_append(uint8 key,const uint8 *data,uint8 size)
+{
+	LogStore_RecordType record ;
+	uint8 page = LOG_STORE_NEXT_PAGE(g_headPage) ;
+	uint8 index ;
+
+	record.sequence = (g_headSequence + 1) & LOG_STORE_SEQUENCE_MASK ;
+	record.key = key ;
+	record.length = size ;
+	for(index = 0 ; index < LOG_STORE_DATA_SIZE ; index++)
+	{
+		record.data[index] = (index < size) ? data[index] : 0xFF ;
+	}
+	record.crc = LogStore_crc(&record) ;
+
+	/*
+	 * The record is one page, so it is written by one page write cycle. It is queued behind the
+	 * earlier records, the EEPROM gets the appends in order so a power loss drops the latest ones only.
+	 */
+	if(LOG_STORE_STORAGE.writeBlock(LOG_STORE_PAGE_ADDRESS(page), (const uint8*)&record, sizeof(LogStore_RecordType)) == ERROR)
+	{
+		return ERROR ;
+	}
+
+	/* The overwritten page may be the latest record of the key */
+	if(LogStore_liveKey(page) != LOG_STORE_NO_KEY)
+	{
+		g_keyPages[LogStore_liveKey(page)] = LOG_STORE_NO_PAGE ;
+	}
+	g_headPage = page ;
+	g_headSequence = record.sequence ;
+	g_keyPages[key] = page ;
+
+	return SUCCESS ;
+}
+
+static uint8 LogStore_liveKey(uint8 page)
+{
+	uint8 key ;
+
+	for(key = 0 ; key < LOG_STORE_NUM_OF_KEYS ; key++)
+	{
+		if(g_keyPages[key] == page)
+		{
+			return key ;
+		}
+	}
+
+	return LOG_STORE_NO_KEY ;
+}
+
+static uint8 LogStore_compact(uint8 page)
+{
+	LogStore_RecordType record ;
+	uint8 key = LogStore_liveKey(page) ;
+
+	if(LOG_STORE_STORAGE.readBlock(LOG_STORE_PAGE_ADDRESS(page), (uint8*)&record, sizeof(LogStore_RecordType)) == ERROR)
+	{
+		return ERROR ;
+	}
+	if(!LogStore_isValid(&record))
+	{
+		/* The record is corrupted, it can not be kept so it is dropped from the index */
+		g_keyPages[key] = LOG_STORE_NO_PAGE ;
+		return SUCCESS ;
+	}
+
+	/* The original record stays valid until its copy is written completely */
+	return LogStore_append(key, record.data, record.length) ;
+}
@@ -0,0 +1,104 @@
+/*
+ ============================================================================
+ Name        : log_store.h
+ Author      : Ahmed Shawky
+ Description : Header File for Log-Structured Record Store Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef LOG_STORE_H_
+#define LOG_STORE_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+#include "storage.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * The storage backend of the store, Storage_internalEeprom keeps the records on-chip and then
+ * the region must be in the first INTERNAL_EEPROM_SIZE bytes.
+ */
+#define LOG_STORE_STORAGE 				Storage_externalEeprom
+
+/*
+ * The store region in the storage, every record takes one EEPROM page so an update
+ * costs one page write. The records are appended round the region, so every page takes
+ * 1/LOG_STORE_NUM_OF_PAGES of the writes. The start address must be page aligned.
+ */
+#define LOG_STORE_START_ADDRESS 		0x0400
+#define LOG_STORE_NUM_OF_PAGES 			32
+#define LOG_STORE_RECORD_SIZE 			EEPROM_PAGE_SIZE
+
+/* Record layout: sequence (2 bytes), key, length, data then the CRC (2 bytes) */
+#define LOG_STORE_DATA_SIZE 			(LOG_STORE_RECORD_SIZE - 6)
+
+/*
+ * Number of keys, every key keeps its latest record only. The region must hold the live records
+ * of all the keys plus two obsolete pages at least, the next page and the target of a copy.
+ */
+#define LOG_STORE_NUM_OF_KEYS 			8
+
+#if(LOG_STORE_NUM_OF_PAGES < (LOG_STORE_NUM_OF_KEYS + 2))
+#error "The log store region is too small for its keys"
+#endif
+
+#if(STORAGE_IS_INTERNAL(LOG_STORE_STORAGE) && \
+   ((LOG_STORE_START_ADDRESS + (LOG_STORE_NUM_OF_PAGES * LOG_STORE_RECORD_SIZE)) > INTERNAL_EEPROM_SIZE))
+#error "The log store region is past the end of the internal EEPROM"
+#endif
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Find the latest record by a binary search over the pages sequence numbers, then index the
+ *	latest valid record of every key in RAM. The TWI driver must be initialized before.
+ */
+void LogStore_init(void);
+
+/* Inputs:
+ * 	1. key : The record key, it should be from 0 → (LOG_STORE_NUM_OF_KEYS - 1).
+ * 	2. Pointer to the record data.
+ * 	3. size: The number of data bytes, it should be from 1 → LOG_STORE_DATA_SIZE.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Append a new version of the key record to the next page, the older versions become obsolete.
+ */
+uint8 LogStore_write(uint8 key, const uint8 *data, uint8 size);
+
+/* Inputs:
+ * 	1. key : The record key, it should be from 0 → (LOG_STORE_NUM_OF_KEYS - 1).
+ * 	2. Pointer to the buffer to be filled with the record data.
+ * 	3. size: The size of the buffer.
+ *
+ * Return Value: SUCCESS if the key has a valid record, ERROR otherwise.
+ *
+ * Description:
+ *	Read the latest record of the key by one block read.
+ */
+uint8 LogStore_read(uint8 key, uint8 *data, uint8 size);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Background compaction, it is called from the main loop. A live record two pages after the
+ *	latest record is copied forward before it is reached, so an update costs one page write.
+ */
+void LogStore_service(void);
+
+#endif /* LOG_STORE_H_ */
@@ -0,0 +1,171 @@
+/*
+ ============================================================================
+ Name        : settings.c
+ Author      : Ahmed Shawky
+ Description : Source File for Double-Buffered Settings Block Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <util/crc16.h>
+#include "settings.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+#define SETTINGS_NUM_OF_SLOTS 			2
+#define SETTINGS_NO_SLOT 				0xFF
+
+#define SETTINGS_SLOT_ADDRESS(slot) 	(SETTINGS_START_ADDRESS + ((uint16)(slot) * SETTINGS_SLOT_SIZE))
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+/* One slot, it is one EEPROM page */
+typedef struct
+{
+	/* Counts the commits, the slot of the newer generation is the active one */
+	uint16 generation ;
+
+	uint8 data[SETTINGS_DATA_SIZE] ;
+
+	/* CRC-CCITT of all the slot bytes before it */
+	uint16 crc ;
+
+}Settings_SlotType;
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* The slot of the latest settings and its generation, the next commit goes to the other slot */
+static uint8 g_activeSlot = SETTINGS_NO_SLOT ;
+static uint16 g_generation ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for calculating the CRC of a slot.
+ */
+static uint16 Settings_crc(const Settings_SlotType *slot);
+
+/*
+ * Function responsible for reading a slot, it returns FALSE for an erased or a torn slot.
+ */
+static boolean Settings_readSlot(uint8 index,Settings_SlotType *slot);
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to the buffer to be filled with the settings.
+ * 	2. size: The size of the buffer, it should be from 1 → SETTINGS_DATA_SIZE.
+ *
+ * Return Value: SUCCESS if a slot is valid, ERROR otherwise and the buffer is not changed.
+ *
+ * Description:
+ *	Read the two slots and load the valid slot of the newest generation. The TWI driver
+ *	must be initialized before.
+ */
+uint8 Settings_load(uint8 *data, uint8 size)
+{
+	Settings_SlotType slots[SETTINGS_NUM_OF_SLOTS] ;
+	boolean valid_a = Settings_readSlot(0, &slots[0]) ;
+	boolean valid_b = Settings_readSlot(1, &slots[1]) ;
+	uint8 index ;
+
+	if(!valid_a && !valid_b)
+	{
+		g_activeSlot = SETTINGS_NO_SLOT ;
+		return ERROR ;
+	}
+
+	/* The generations wrap, B is newer if it is less than half the range after A */
+	if(valid_a && valid_b)
+	{
+		g_activeSlot = ((sint16)(slots[1].generation - slots[0].generation) > 0) ? 1 : 0 ;
+	}
+	else
+	{
+		g_activeSlot = valid_a ? 0 : 1 ;
+	}
+	g_generation = slots[g_activeSlot].generation ;
+
+	for(index = 0 ; (index < size) && (index < SETTINGS_DATA_SIZE) ; index++)
+	{
+		data[index] = slots[g_activeSlot].data[index] ;
+	}
+
+	return SUCCESS ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the settings.
+ * 	2. size: The number of settings bytes, it should be from 1 → SETTINGS_DATA_SIZE.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Write the settings to the inactive slot with the next generation. The active slot is not
+ *	touched, so a power loss during the write keeps the older settings.
+ */
+uint8 Settings_commit(const uint8 *data, uint8 size)
+{
+	Settings_SlotType slot ;
+	uint8 index = (g_activeSlot == 0) ? 1 : 0 ;
+	uint8 count ;
+
+	if((size == 0) || (size > SETTINGS_DATA_SIZE))
+	{
+		return ERROR ;
+	}
+
+	slot.generation = g_generation + 1 ;
+	for(count = 0 ; count < SETTINGS_DATA_SIZE ; count++)
+	{
+		slot.data[count] = (count < size) ? data[count] : 0xFF ;
+	}
+	slot.crc = Settings_crc(&slot) ;
+
+	/* The slot is one page, on the external EEPROM it is written by one page write cycle after the queued writes */
+	if(SETTINGS_STORAGE.writeBlock(SETTINGS_SLOT_ADDRESS(index), (const uint8*)&slot, sizeof(Settings_SlotType)) == ERROR)
+	{
+		return ERROR ;
+	}
+
+	g_activeSlot = index ;
+	g_generation = slot.generation ;
+
+	return SUCCESS ;
+}
+
+static uint16 Settings_crc(const Settings_SlotType *slot)
+{
+	const uint8 *bytes = (const uint8*)slot ;
+	uint16 crc = 0xFFFF ;
+	uint8 index ;
+
+	for(index = 0 ; index < (uint8)(sizeof(Settings_SlotType) - sizeof(slot->crc)) ; index++)
+	{
+		crc = _crc_ccitt_update(crc, bytes[index]);
+	}
+
+	return crc ;
+}
+
+static boolean Settings_readSlot(uint8 index,Settings_SlotType *slot)
+{
+	if(SETTINGS_STORAGE.readBlock(SETTINGS_SLOT_ADDRESS(index), (uint8*)slot, sizeof(Settings_SlotType)) == ERROR)
+	{
+		return FALSE ;
+	}
+
+	return (slot->crc == Settings_crc(slot)) ;
+}
@@ -0,0 +1,71 @@
+/*
+ ============================================================================
+ Name        : settings.h
+ Author      : Ahmed Shawky
+ Description : Header File for Double-Buffered Settings Block Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+#include "storage.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * The storage backend of the settings, Storage_internalEeprom keeps them on-chip and then
+ * the slots must be in the first INTERNAL_EEPROM_SIZE bytes.
+ */
+#define SETTINGS_STORAGE 				Storage_externalEeprom
+
+/*
+ * The settings block has two slots A and B in the storage, every slot is one EEPROM page
+ * so a commit costs one page write. The start address must be page aligned.
+ */
+#define SETTINGS_START_ADDRESS 			0x0380
+#define SETTINGS_SLOT_SIZE 				EEPROM_PAGE_SIZE
+
+/* Slot layout: generation (2 bytes), data then the CRC (2 bytes) */
+#define SETTINGS_DATA_SIZE 				(SETTINGS_SLOT_SIZE - 4)
+
+#if(STORAGE_IS_INTERNAL(SETTINGS_STORAGE) && ((SETTINGS_START_ADDRESS + (2 * SETTINGS_SLOT_SIZE)) > INTERNAL_EEPROM_SIZE))
+#error "The settings slots are past the end of the internal EEPROM"
+#endif
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to the buffer to be filled with the settings.
+ * 	2. size: The size of the buffer, it should be from 1 → SETTINGS_DATA_SIZE.
+ *
+ * Return Value: SUCCESS if a slot is valid, ERROR otherwise and the buffer is not changed.
+ *
+ * Description:
+ *	Read the two slots and load the valid slot of the newest generation. The TWI driver
+ *	must be initialized before.
+ */
+uint8 Settings_load(uint8 *data, uint8 size);
+
+/* Inputs:
+ * 	1. Pointer to the settings.
+ * 	2. size: The number of settings bytes, it should be from 1 → SETTINGS_DATA_SIZE.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Write the settings to the inactive slot with the next generation. The active slot is not
+ *	touched, so a power loss during the write keeps the older settings.
+ */
+uint8 Settings_commit(const uint8 *data, uint8 size);
+
+#endif /* SETTINGS_H_ */
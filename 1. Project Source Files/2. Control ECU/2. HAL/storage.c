@@ -0,0 +1,100 @@
+/*
+ ============================================================================
+ Name        : storage.c
+ Author      : Ahmed Shawky
+ Description : Source File for Storage Backends Interface
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "storage.h"
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Functions responsible for adapting the internal EEPROM driver to the backend interface.
+ */
+static uint8 Storage_internalRead(uint32 address,uint8 *data,uint16 size);
+static uint8 Storage_internalWrite(uint32 address,const uint8 *data,uint16 size);
+static uint8 Storage_internalWaitReady(void);
+static uint32 Storage_internalCapacity(void);
+
+/*
+ * Functions responsible for adapting the external EEPROM driver to the backend interface.
+ */
+static uint8 Storage_externalWrite(uint32 address,const uint8 *data,uint16 size);
+static uint8 Storage_externalWaitReady(void);
+
+/****************************************************************************
+ * 							   Global Variables								*
+ ****************************************************************************/
+
+const Storage_BackendType Storage_internalEeprom =
+{
+	Storage_internalRead, Storage_internalWrite, Storage_internalWaitReady, Storage_internalCapacity
+};
+
+const Storage_BackendType Storage_externalEeprom =
+{
+	EEPROM_readBlock, Storage_externalWrite, Storage_externalWaitReady, EEPROM_getSize
+};
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+static uint8 Storage_internalRead(uint32 address,uint8 *data,uint16 size)
+{
+	if(address >= INTERNAL_EEPROM_SIZE)
+	{
+		return ERROR ;
+	}
+
+	return InternalEeprom_readBlock((uint16)address, data, size) ;
+}
+
+static uint8 Storage_internalWrite(uint32 address,const uint8 *data,uint16 size)
+{
+	if(address >= INTERNAL_EEPROM_SIZE)
+	{
+		return ERROR ;
+	}
+
+	return InternalEeprom_writeBlock((uint16)address, data, size) ;
+}
+
+static uint8 Storage_internalWaitReady(void)
+{
+	while(!InternalEeprom_isReady());
+
+	return SUCCESS ;
+}
+
+static uint32 Storage_internalCapacity(void)
+{
+	return INTERNAL_EEPROM_SIZE ;
+}
+
+static uint8 Storage_externalWrite(uint32 address,const uint8 *data,uint16 size)
+{
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+	return EEPROM_queueBlock(address, data, size) ;
+#else
+	return EEPROM_writeBlock(address, data, size) ;
+#endif
+}
+
+static uint8 Storage_externalWaitReady(void)
+{
+#if(EEPROM_QUEUE_ENABLE == TRUE)
+	return EEPROM_sync() ;
+#else
+	/* Every write waits for the last write cycle before it starts */
+	return SUCCESS ;
+#endif
+}
@@ -0,0 +1,66 @@
+/*
+ ============================================================================
+ Name        : storage.h
+ Author      : Ahmed Shawky
+ Description : Header File for Storage Backends Interface
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef STORAGE_H_
+#define STORAGE_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+#include "external_eeprom.h"
+#include "internal_eeprom.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * Evaluated by #if to check that a region of a driver on the internal EEPROM ends within
+ * INTERNAL_EEPROM_SIZE, the names of the other backends give FALSE.
+ */
+#define STORAGE_IS_INTERNAL(backend) 		STORAGE_IS_INTERNAL_NAME(backend)
+#define STORAGE_IS_INTERNAL_NAME(backend) 	(backend##_INTERNAL == TRUE)
+#define Storage_internalEeprom_INTERNAL 	TRUE
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+/*
+ * A storage backend, the drivers above select theirs at build time by its object name, so
+ * the calls through the constant table are resolved by the compiler.
+ */
+typedef struct
+{
+	/* Read a block, it returns SUCCESS or ERROR */
+	uint8 (*readBlock)(uint32 address, uint8 *data, uint16 size);
+
+	/* Start writing a block, the reads return the new data at once */
+	uint8 (*writeBlock)(uint32 address, const uint8 *data, uint16 size);
+
+	/* Wait until the written blocks are in the memory, it returns SUCCESS or ERROR */
+	uint8 (*waitReady)(void);
+
+	/* The size of the memory in bytes */
+	uint32 (*getCapacity)(void);
+
+}Storage_BackendType;
+
+/****************************************************************************
+ * 							   Global Variables								*
+ ****************************************************************************/
+
+/* The ATmega32 1KB EEPROM: fast reads, one write cycle for every changed byte, the writes are queued */
+extern const Storage_BackendType Storage_internalEeprom ;
+
+/* The external 24Cxx EEPROM on the TWI bus: one write cycle for every page, the writes are queued */
+extern const Storage_BackendType Storage_externalEeprom ;
+
+#endif /* STORAGE_H_ */
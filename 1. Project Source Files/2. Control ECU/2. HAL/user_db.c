@@ -0,0 +1,340 @@
+/*
+ ============================================================================
+ Name        : user_db.c
+ Author      : Ahmed Shawky
+ Description : Source File for Users Credentials Database Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "user_db.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * Slot states in the low nibble of the slot state byte, the user flags are in the high nibble.
+ * An erased EEPROM slot reads 0xFF so it is empty, a deleted slot is written with 0x00.
+ */
+#define USER_DB_STATE_MASK 				0x0F
+#define USER_DB_SLOT_EMPTY 				0x0F
+#define USER_DB_SLOT_USED 				0x05
+#define USER_DB_SLOT_DELETED 			0x00
+#define USER_DB_FLAGS_SHIFT 			4
+
+#define USER_DB_NO_SLOT 				0xFF
+
+#define USER_DB_BUCKET_ADDRESS(bucket) 	(USER_DB_START_ADDRESS + ((uint16)(bucket) * USER_DB_BUCKET_SIZE))
+#define USER_DB_SLOT_ADDRESS(bucket,slot) (USER_DB_BUCKET_ADDRESS(bucket) + ((uint16)(slot) * USER_DB_SLOT_SIZE))
+
+/* FNV-1a 32-bit hash constants */
+#define USER_DB_FNV_OFFSET 				2166136261UL
+#define USER_DB_FNV_PRIME 				16777619UL
+
+#if((EEPROM_PAGE_SIZE % USER_DB_SLOT_SIZE) != 0)
+#error "A users table slot must not cross an EEPROM page"
+#endif
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+/* One user record, the slots never cross an EEPROM page so a slot write is one page write */
+typedef struct
+{
+	uint32 digest ;
+
+	uint16 user_id ;
+
+	uint8 doors ;
+
+	uint8 state ;
+
+}UserDb_SlotType;
+
+/* Probe result, the slot of the digest and the first reusable slot of its probe sequence */
+typedef struct
+{
+	uint8 found_bucket ;
+	uint8 found_slot ;
+
+	uint8 free_bucket ;
+	uint8 free_slot ;
+
+}UserDb_ProbeType;
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+static uint8 g_bloom[USER_DB_BLOOM_BITS / 8] ;
+
+static UserDb_StatsType g_stats ;
+
+/****************************************************************************
+ * 						 Static Functions Prototypes						*
+ ****************************************************************************/
+
+/*
+ * Function responsible for calculating the salted digest of a PIN.
+ */
+static uint32 UserDb_digest(const uint8 *pin,uint8 size);
+
+/*
+ * Function responsible for adding a digest to the bloom filter or testing it.
+ */
+static boolean UserDb_bloom(uint32 digest,boolean add);
+
+/*
+ * Function responsible for walking the probe sequence of a digest, it stops at the digest or at an empty slot.
+ */
+static uint8 UserDb_probe(uint32 digest,UserDb_SlotType *found,UserDb_ProbeType *probe);
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the users table once to count the users and build the RAM bloom filter.
+ *	The TWI driver must be initialized before.
+ */
+void UserDb_init(void)
+{
+	UserDb_SlotType bucket[USER_DB_SLOTS_PER_BUCKET] ;
+	uint8 index ;
+	uint8 slot ;
+
+	for(index = 0 ; index < sizeof(g_bloom) ; index++)
+	{
+		g_bloom[index] = 0 ;
+	}
+	g_stats.users = 0 ;
+
+	for(index = 0 ; index < USER_DB_NUM_OF_BUCKETS ; index++)
+	{
+		if(EEPROM_readBlock(USER_DB_BUCKET_ADDRESS(index), (uint8*)bucket, sizeof(bucket)) == ERROR)
+		{
+			continue ;
+		}
+		for(slot = 0 ; slot < USER_DB_SLOTS_PER_BUCKET ; slot++)
+		{
+			if((bucket[slot].state & USER_DB_STATE_MASK) == USER_DB_SLOT_USED)
+			{
+				UserDb_bloom(bucket[slot].digest, TRUE);
+				g_stats.users++ ;
+			}
+		}
+	}
+}
+
+/* Inputs:
+ * 	1. Pointer to the PIN digits.
+ * 	2. size: The number of digits.
+ * 	3. Pointer to the structure to be filled with the user attributes.
+ *
+ * Return Value: SUCCESS if the PIN belongs to a user, ERROR otherwise.
+ *
+ * Description:
+ *	Find the user of the PIN, it reads the home bucket of the PIN digest by one block read.
+ */
+uint8 UserDb_find(const uint8 *pin, uint8 size, UserDb_UserType *user)
+{
+	uint32 digest = UserDb_digest(pin, size) ;
+	UserDb_SlotType slot ;
+	UserDb_ProbeType probe ;
+
+	g_stats.lookups++ ;
+	if(!UserDb_bloom(digest, FALSE))
+	{
+		g_stats.bloom_rejects++ ;
+		return ERROR ;
+	}
+
+	if((UserDb_probe(digest, &slot, &probe) == ERROR) || (probe.found_slot == USER_DB_NO_SLOT))
+	{
+		return ERROR ;
+	}
+
+	user->user_id = slot.user_id ;
+	user->doors = slot.doors ;
+	user->flags = (slot.state >> USER_DB_FLAGS_SHIFT) ;
+
+	return SUCCESS ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the PIN digits.
+ * 	2. size: The number of digits.
+ * 	3. Pointer to the user attributes.
+ *
+ * Return Value: SUCCESS if the user is added, ERROR if the PIN is used or the table is full.
+ *
+ * Description:
+ *	Add a user in the first free slot of the PIN probe sequence, it costs one page write.
+ */
+uint8 UserDb_add(const uint8 *pin, uint8 size, const UserDb_UserType *user)
+{
+	uint32 digest = UserDb_digest(pin, size) ;
+	UserDb_SlotType slot ;
+	UserDb_ProbeType probe ;
+
+	if((UserDb_probe(digest, &slot, &probe) == ERROR) || (probe.found_slot != USER_DB_NO_SLOT) || (probe.free_slot == USER_DB_NO_SLOT))
+	{
+		return ERROR ;
+	}
+
+	slot.digest = digest ;
+	slot.user_id = user->user_id ;
+	slot.doors = user->doors ;
+	slot.state = (uint8)((user->flags << USER_DB_FLAGS_SHIFT) | USER_DB_SLOT_USED) ;
+	/* A reused slot may hold the same digest or attributes, their bytes are not written again */
+	if(EEPROM_updateBlock(USER_DB_SLOT_ADDRESS(probe.free_bucket, probe.free_slot), (const uint8*)&slot, sizeof(slot), NULL_PTR) == ERROR)
+	{
+		return ERROR ;
+	}
+
+	UserDb_bloom(digest, TRUE);
+	g_stats.users++ ;
+
+	return SUCCESS ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the PIN digits.
+ * 	2. size: The number of digits.
+ *
+ * Return Value: SUCCESS if the user is removed, ERROR if the PIN is not found.
+ *
+ * Description:
+ *	Remove the user of the PIN, its slot is marked deleted so the probe sequences stay valid.
+ */
+uint8 UserDb_remove(const uint8 *pin, uint8 size)
+{
+	UserDb_SlotType slot ;
+	UserDb_ProbeType probe ;
+
+	if((UserDb_probe(UserDb_digest(pin, size), &slot, &probe) == ERROR) || (probe.found_slot == USER_DB_NO_SLOT))
+	{
+		return ERROR ;
+	}
+
+	/* The digest bits stay in the bloom filter until the next init, they only cost a bucket read */
+	if(EEPROM_update((USER_DB_SLOT_ADDRESS(probe.found_bucket, probe.found_slot) + (USER_DB_SLOT_SIZE - 1)), USER_DB_SLOT_DELETED, NULL_PTR) == ERROR)
+	{
+		return ERROR ;
+	}
+	g_stats.users-- ;
+
+	return SUCCESS ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the instrumentation counters.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the lookups, bloom filter rejects and bucket reads counters.
+ */
+void UserDb_getStats(UserDb_StatsType *stats)
+{
+	*stats = g_stats ;
+}
+
+static uint32 UserDb_digest(const uint8 *pin,uint8 size)
+{
+	uint32 hash = USER_DB_FNV_OFFSET ;
+	uint8 index ;
+
+	hash = (hash ^ (uint8)USER_DB_DIGEST_SALT) * USER_DB_FNV_PRIME ;
+	hash = (hash ^ (uint8)(USER_DB_DIGEST_SALT >> 8)) * USER_DB_FNV_PRIME ;
+	for(index = 0 ; index < size ; index++)
+	{
+		hash = (hash ^ pin[index]) * USER_DB_FNV_PRIME ;
+	}
+
+	/* The PIN length is hashed too, so "12" and "012" differ */
+	hash = (hash ^ size) * USER_DB_FNV_PRIME ;
+
+	return hash ;
+}
+
+static boolean UserDb_bloom(uint32 digest,boolean add)
+{
+	/* Double hashing, the bit of hash function i is (h1 + i*h2) */
+	uint16 h1 = (uint16)digest ;
+	uint16 h2 = (uint16)(digest >> 16) | 1 ;
+	uint16 bit ;
+	uint8 count ;
+
+	for(count = 0 ; count < USER_DB_BLOOM_HASHES ; count++)
+	{
+		bit = (h1 + (count * h2)) & (USER_DB_BLOOM_BITS - 1) ;
+		if(add)
+		{
+			SET_BIT(g_bloom[bit >> 3], (bit & 0x07));
+		}
+		else if(BIT_IS_CLEAR(g_bloom[bit >> 3], (bit & 0x07)))
+		{
+			return FALSE ;
+		}
+	}
+
+	return TRUE ;
+}
+
+static uint8 UserDb_probe(uint32 digest,UserDb_SlotType *found,UserDb_ProbeType *probe)
+{
+	UserDb_SlotType bucket[USER_DB_SLOTS_PER_BUCKET] ;
+	uint8 index = (uint8)(digest % USER_DB_NUM_OF_BUCKETS) ;
+	uint8 count ;
+	uint8 slot ;
+	uint8 state ;
+
+	probe->found_slot = USER_DB_NO_SLOT ;
+	probe->free_slot = USER_DB_NO_SLOT ;
+
+	for(count = 0 ; count < USER_DB_MAX_PROBES ; count++)
+	{
+		/* One block read for the whole bucket */
+		g_stats.bucket_reads++ ;
+		if(EEPROM_readBlock(USER_DB_BUCKET_ADDRESS(index), (uint8*)bucket, sizeof(bucket)) == ERROR)
+		{
+			return ERROR ;
+		}
+
+		for(slot = 0 ; slot < USER_DB_SLOTS_PER_BUCKET ; slot++)
+		{
+			state = bucket[slot].state & USER_DB_STATE_MASK ;
+			if((state == USER_DB_SLOT_USED) && (bucket[slot].digest == digest))
+			{
+				*found = bucket[slot] ;
+				probe->found_bucket = index ;
+				probe->found_slot = slot ;
+				return SUCCESS ;
+			}
+			if((state != USER_DB_SLOT_USED) && (probe->free_slot == USER_DB_NO_SLOT))
+			{
+				probe->free_bucket = index ;
+				probe->free_slot = slot ;
+			}
+			if(state == USER_DB_SLOT_EMPTY)
+			{
+				/* The digest was never inserted after this slot */
+				return SUCCESS ;
+			}
+		}
+
+		index = ((index + 1) < USER_DB_NUM_OF_BUCKETS) ? (index + 1) : 0 ;
+	}
+
+	return SUCCESS ;
+}
@@ -0,0 +1,149 @@
+/*
+ ============================================================================
+ Name        : user_db.h
+ Author      : Ahmed Shawky
+ Description : Header File for Users Credentials Database Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef USER_DB_H_
+#define USER_DB_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+#include "external_eeprom.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * The users table region in the external EEPROM, it is a hash table of buckets and every bucket
+ * holds USER_DB_SLOTS_PER_BUCKET user records, so a lookup reads one bucket by one block read.
+ * The start address must be aligned to the bucket size.
+ * The table fills the last 512 bytes of the 24C16, so it holds 64 users. A 24C512 bank has room
+ * for more buckets, 256 buckets (1024 users) at most as the bucket index is 8 bits.
+ */
+#define USER_DB_START_ADDRESS 			0x0600
+#define USER_DB_NUM_OF_BUCKETS 			16
+#define USER_DB_SLOTS_PER_BUCKET 		4
+#define USER_DB_SLOT_SIZE 				8
+#define USER_DB_BUCKET_SIZE 			(USER_DB_SLOTS_PER_BUCKET * USER_DB_SLOT_SIZE)
+#define USER_DB_CAPACITY 				(USER_DB_NUM_OF_BUCKETS * USER_DB_SLOTS_PER_BUCKET)
+
+#if(USER_DB_NUM_OF_BUCKETS > 256)
+#error "The users table bucket index is 8 bits"
+#endif
+
+/* Linear probing over the next buckets, insert, delete and lookup read this number of buckets at most */
+#define USER_DB_MAX_PROBES 				4
+
+/* The PIN digest is salted per installation, so the stored digests differ between the sites */
+#ifndef USER_DB_DIGEST_SALT
+#define USER_DB_DIGEST_SALT 			0x5A3C
+#endif
+
+/*
+ * RAM bloom filter of the stored digests, a PIN not in the filter is rejected without any I2C read.
+ * With 64 users, 512 bits and 3 hash functions about 3% of the unknown PINs pass the filter.
+ */
+#define USER_DB_BLOOM_BITS 				512
+#define USER_DB_BLOOM_HASHES 			3
+
+/* User attributes flags, 4 flags at most */
+#define USER_DB_FLAG_ADMIN 				0x01
+#define USER_DB_ALL_FLAGS_MASK 			0x0F
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef struct
+{
+	uint16 user_id ;
+
+	/* Bit mask of the doors the user can open, bit n for door n */
+	uint8 doors ;
+
+	uint8 flags ;
+
+}UserDb_UserType;
+
+/* Users database instrumentation counters */
+typedef struct
+{
+	uint16 lookups ;
+
+	/* Lookups rejected by the bloom filter without reading the EEPROM */
+	uint16 bloom_rejects ;
+
+	/* Buckets read by the lookups that passed the filter, the adds and the removes */
+	uint16 bucket_reads ;
+
+	uint16 users ;
+
+}UserDb_StatsType;
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the users table once to count the users and build the RAM bloom filter.
+ *	The TWI driver must be initialized before.
+ */
+void UserDb_init(void);
+
+/* Inputs:
+ * 	1. Pointer to the PIN digits.
+ * 	2. size: The number of digits.
+ * 	3. Pointer to the structure to be filled with the user attributes.
+ *
+ * Return Value: SUCCESS if the PIN belongs to a user, ERROR otherwise.
+ *
+ * Description:
+ *	Find the user of the PIN, it reads the home bucket of the PIN digest by one block read.
+ */
+uint8 UserDb_find(const uint8 *pin, uint8 size, UserDb_UserType *user);
+
+/* Inputs:
+ * 	1. Pointer to the PIN digits.
+ * 	2. size: The number of digits.
+ * 	3. Pointer to the user attributes.
+ *
+ * Return Value: SUCCESS if the user is added, ERROR if the PIN is used or the table is full.
+ *
+ * Description:
+ *	Add a user in the first free slot of the PIN probe sequence, it costs one page write.
+ */
+uint8 UserDb_add(const uint8 *pin, uint8 size, const UserDb_UserType *user);
+
+/* Inputs:
+ * 	1. Pointer to the PIN digits.
+ * 	2. size: The number of digits.
+ *
+ * Return Value: SUCCESS if the user is removed, ERROR if the PIN is not found.
+ *
+ * Description:
+ *	Remove the user of the PIN, its slot is marked deleted so the probe sequences stay valid.
+ */
+uint8 UserDb_remove(const uint8 *pin, uint8 size);
+
+/* Inputs:
+ * 	1. Pointer to the structure to be filled with a snapshot of the instrumentation counters.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Read the lookups, bloom filter rejects and bucket reads counters.
+ */
+void UserDb_getStats(UserDb_StatsType *stats);
+
+#endif /* USER_DB_H_ */
@@ -0,0 +1,158 @@
+/*
+ ============================================================================
+ Name        : adc.c
+ Author      : Ahmed Shawky
+ Description : Source File for ADC Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "adc.h"
+#include "gpio.h"
+#include "common_macros.h"
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Global variables to hold the address of the call back function in the application */
+static void (*volatile g_callBackPtr)(uint16 sample) = NULL_PTR ;
+
+/* Samples ring buffer, it is written by the interrupt and read by ADC_getSample() */
+static volatile uint16 g_buffer[ADC_BUFFER_SIZE] ;
+static volatile uint8 g_head = 0 ;
+static volatile uint8 g_tail = 0 ;
+static volatile uint16 g_overruns = 0 ;
+
+/****************************************************************************
+ * 						 Interrupt Service Routines							*
+ ****************************************************************************/
+ISR(ADC_vect)
+{
+	uint16 sample = ADC ;
+	uint8 next ;
+
+	/* The samples are passed to the Call Back function or kept for ADC_getSample(), not both */
+	if(g_callBackPtr != NULL_PTR)
+	{
+		g_callBackPtr(sample);
+		return ;
+	}
+
+	next = ( g_head + 1 ) & ( ADC_BUFFER_SIZE - 1 ) ;
+	if(next != g_tail)
+	{
+		g_buffer[g_head] = sample ;
+		g_head = next ;
+	}
+	else
+	{
+		g_overruns++ ;
+	}
+}
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : ADC_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start the ADC in free running mode on the required channel, the conversion complete
+ *	interrupt passes every sample to the Call Back function, or stores it in the ring buffer
+ *	if no Call Back function is set.
+ *	A conversion takes 13 ADC clocks, F_CPU/128 at 8MHz gives 4.8K samples per second.
+ */
+void ADC_init(const ADC_ConfigType *Config_Ptr)
+{
+	/* Stop the ADC while it is being configured */
+	ADCSRA = 0 ;
+
+	g_head = 0 ;
+	g_tail = 0 ;
+
+	GPIO_setupPinDirection(PORTA_ID, Config_Ptr->channel & 0x07, PIN_INPUT);
+
+	/* Reference voltage, right adjusted result and the input channel */
+	ADMUX = ( ( Config_Ptr->ref_volt & 0x03 ) << REFS0 ) | ( Config_Ptr->channel & 0x07 ) ;
+
+	/* Free running auto trigger source */
+	SFIOR &= ~((1<<ADTS2) | (1<<ADTS1) | (1<<ADTS0)) ;
+
+	/* Enable the ADC with auto trigger and interrupt, then start the first conversion */
+	ADCSRA = (1<<ADEN) | (1<<ADATE) | (1<<ADIE) | (1<<ADIF) | ( Config_Ptr->prescaler & 0x07 ) ;
+	SET_BIT(ADCSRA,ADSC);
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop the conversions and switch the ADC off to save its power.
+ */
+void ADC_deInit(void)
+{
+	ADCSRA = 0 ;
+}
+
+/* Inputs:
+ * 	1. Pointer to the variable to be filled with the oldest sample.
+ *
+ * Return Value: TRUE if a sample was read from the ring buffer, FALSE if the buffer is empty.
+ *
+ * Description:
+ *	Read the oldest sample without blocking.
+ */
+boolean ADC_getSample(uint16 *sample)
+{
+	if(g_tail == g_head)
+	{
+		return FALSE ;
+	}
+
+	*sample = g_buffer[g_tail] ;
+	g_tail = ( g_tail + 1 ) & ( ADC_BUFFER_SIZE - 1 ) ;
+
+	return TRUE ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: Number of samples lost because the ring buffer was full.
+ *
+ * Description:
+ *	Read the ring buffer overrun counter.
+ */
+uint16 ADC_getOverruns(void)
+{
+	uint16 overruns ;
+	uint8 sreg = SREG ;
+	cli();
+	overruns = g_overruns ;
+	SREG = sreg ;
+	return overruns ;
+}
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a sample parameter and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address, it is called from the conversion
+ *	complete interrupt with every new sample.
+ */
+void ADC_setCallBack(void(*a_ptr)(uint16 sample))
+{
+	/* Save the address of the Call back function in a global variable */
+	g_callBackPtr = a_ptr ;
+}
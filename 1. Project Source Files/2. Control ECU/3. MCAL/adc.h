@@ -0,0 +1,126 @@
+/*
+ ============================================================================
+ Name        : adc.h
+ Author      : Ahmed Shawky
+ Description : Header File for ADC Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef ADC_H_
+#define ADC_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+#define ADC_MAXIMUM_VALUE 				1023
+
+/* Number of samples kept in the ring buffer, it must be a power of 2 */
+#define ADC_BUFFER_SIZE 				16
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef enum
+{
+	ADC_AREF,
+
+	ADC_AVCC,
+
+	ADC_INTERNAL_2_56V = 0x03
+
+}ADC_ReferenceVoltage;
+
+typedef enum
+{
+	ADC_F_CPU_2 = 0x01,
+
+	ADC_F_CPU_4,
+
+	ADC_F_CPU_8,
+
+	ADC_F_CPU_16,
+
+	ADC_F_CPU_32,
+
+	ADC_F_CPU_64,
+
+	ADC_F_CPU_128
+
+}ADC_Prescaler;
+
+typedef struct
+{
+	ADC_ReferenceVoltage ref_volt ;
+
+	ADC_Prescaler prescaler ;
+
+	/* Input channel ADC0 → ADC7 (PA0 → PA7) */
+	uint8 channel ;
+
+}ADC_ConfigType;
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : ADC_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start the ADC in free running mode on the required channel, the conversion complete
+ *	interrupt passes every sample to the Call Back function, or stores it in the ring buffer
+ *	if no Call Back function is set.
+ *	A conversion takes 13 ADC clocks, F_CPU/128 at 8MHz gives 4.8K samples per second.
+ */
+void ADC_init(const ADC_ConfigType *Config_Ptr);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop the conversions and switch the ADC off to save its power.
+ */
+void ADC_deInit(void);
+
+/* Inputs:
+ * 	1. Pointer to the variable to be filled with the oldest sample.
+ *
+ * Return Value: TRUE if a sample was read from the ring buffer, FALSE if the buffer is empty.
+ *
+ * Description:
+ *	Read the oldest sample without blocking, the buffer is used only while no Call Back
+ *	function is set.
+ */
+boolean ADC_getSample(uint16 *sample);
+
+/* Inputs: void.
+ *
+ * Return Value: Number of samples lost because the ring buffer was full.
+ *
+ * Description:
+ *	Read the ring buffer overrun counter.
+ */
+uint16 ADC_getOverruns(void);
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a sample parameter and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address, it is called from the conversion
+ *	complete interrupt with every new sample in place of the ring buffer.
+ */
+void ADC_setCallBack(void(*a_ptr)(uint16 sample));
+
+#endif /* ADC_H_ */
@@ -0,0 +1,171 @@
+/*
+ ============================================================================
+ Name        : internal_eeprom.c
+ Author      : Ahmed Shawky
+ Description : Source File for Internal EEPROM Memory Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "internal_eeprom.h"
+#include "common_macros.h"
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Write queue, it is filled by InternalEeprom_writeBlock and emptied by the interrupt */
+static volatile uint16 g_queueAddress[INTERNAL_EEPROM_QUEUE_SIZE] ;
+static volatile uint8 g_queueData[INTERNAL_EEPROM_QUEUE_SIZE] ;
+static volatile uint8 g_queueHead = 0 ;
+static volatile uint8 g_queueTail = 0 ;
+
+/****************************************************************************
+ * 						 Interrupt Service Routines							*
+ ****************************************************************************/
+ISR(EE_RDY_vect)
+{
+	/* A byte read takes 4 cycles and a write cycle takes 8.5ms, so the unchanged bytes are skipped */
+	while(g_queueTail != g_queueHead)
+	{
+		EEAR = g_queueAddress[g_queueTail] ;
+		SET_BIT(EECR, EERE);
+		if(EEDR != g_queueData[g_queueTail])
+		{
+			EEDR = g_queueData[g_queueTail] ;
+			g_queueTail = ( g_queueTail + 1 ) & ( INTERNAL_EEPROM_QUEUE_SIZE - 1 ) ;
+
+			/* EEWE must be set within 4 cycles after EEMWE, the interrupts are disabled here */
+			SET_BIT(EECR, EEMWE);
+			SET_BIT(EECR, EEWE);
+			return ;
+		}
+		g_queueTail = ( g_queueTail + 1 ) & ( INTERNAL_EEPROM_QUEUE_SIZE - 1 ) ;
+	}
+
+	/* The interrupt is fired as long as the EEPROM is ready, so it is disabled when the queue is empty */
+	CLEAR_BIT(EECR, EERIE);
+}
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the buffer to be filled with the data.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Read a block from the internal EEPROM, the queued bytes are returned in place of the
+ *	EEPROM bytes. It waits for the running write cycle first (8.5ms at most).
+ */
+uint8 InternalEeprom_readBlock(uint16 address, uint8 *data, uint16 size)
+{
+	uint8 sreg ;
+	uint8 index ;
+	uint16 count ;
+
+	if(((uint32)address + size) > INTERNAL_EEPROM_SIZE)
+	{
+		return ERROR ;
+	}
+
+	/* The queue is held while reading, the interrupt would change EEAR and start new write cycles */
+	sreg = SREG ;
+	cli();
+	CLEAR_BIT(EECR, EERIE);
+	SREG = sreg ;
+
+	/* The EEPROM can not be read during a write cycle */
+	while(BIT_IS_SET(EECR, EEWE));
+
+	for(count = 0; count < size; count++)
+	{
+		EEAR = address + count ;
+		SET_BIT(EECR, EERE);
+		data[count] = EEDR ;
+	}
+
+	/* The queued bytes are newer than the EEPROM bytes, the later ones are newer than the earlier ones */
+	for(index = g_queueTail; index != g_queueHead; index = ( index + 1 ) & ( INTERNAL_EEPROM_QUEUE_SIZE - 1 ))
+	{
+		if((g_queueAddress[index] >= address) && (g_queueAddress[index] < (address + size)))
+		{
+			data[g_queueAddress[index] - address] = g_queueData[index] ;
+		}
+	}
+
+	if(g_queueTail != g_queueHead)
+	{
+		SET_BIT(EECR, EERIE);
+	}
+
+	return SUCCESS ;
+}
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into the internal EEPROM.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Queue a block to be written by the EEPROM ready interrupt, the bytes equal to the EEPROM
+ *	bytes are skipped by the interrupt. It waits only if the queue is full, the global
+ *	interrupts must be enabled.
+ */
+uint8 InternalEeprom_writeBlock(uint16 address, const uint8 *data, uint16 size)
+{
+	uint8 sreg ;
+	uint8 next ;
+
+	if(((uint32)address + size) > INTERNAL_EEPROM_SIZE)
+	{
+		return ERROR ;
+	}
+
+	while(size != 0)
+	{
+		next = ( g_queueHead + 1 ) & ( INTERNAL_EEPROM_QUEUE_SIZE - 1 ) ;
+
+		/* The interrupt frees one entry every write cycle */
+		while(next == g_queueTail);
+
+		g_queueAddress[g_queueHead] = address ;
+		g_queueData[g_queueHead] = *data ;
+		g_queueHead = next ;
+
+		/* EECR is changed by the interrupt too */
+		sreg = SREG ;
+		cli();
+		SET_BIT(EECR, EERIE);
+		SREG = sreg ;
+
+		data++ ;
+		address++ ;
+		size-- ;
+	}
+
+	return SUCCESS ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: TRUE if the queue is empty and no write cycle is running, FALSE otherwise.
+ *
+ * Description:
+ *	Check the internal EEPROM write queue.
+ */
+boolean InternalEeprom_isReady(void)
+{
+	return (g_queueTail == g_queueHead) && BIT_IS_CLEAR(EECR, EEWE) ;
+}
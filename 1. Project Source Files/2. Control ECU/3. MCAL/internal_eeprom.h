@@ -0,0 +1,74 @@
+/*
+ ============================================================================
+ Name        : internal_eeprom.h
+ Author      : Ahmed Shawky
+ Description : Header File for Internal EEPROM Memory Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef INTERNAL_EEPROM_H_
+#define INTERNAL_EEPROM_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+#define ERROR 		0
+#define SUCCESS 	1
+
+/* ATmega32 on-chip EEPROM: 1KB, every byte is written by its own write cycle (8.5ms) */
+#define INTERNAL_EEPROM_SIZE 			1024
+
+/*
+ * Number of bytes kept in the write queue, it must be a power of 2. The EEPROM ready interrupt
+ * writes the queued bytes one by one, so a block write does not wait for the write cycles.
+ */
+#define INTERNAL_EEPROM_QUEUE_SIZE 		32
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the buffer to be filled with the data.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of read operation.
+ *
+ * Description:
+ *	Read a block from the internal EEPROM, the queued bytes are returned in place of the
+ *	EEPROM bytes. It waits for the running write cycle first (8.5ms at most).
+ */
+uint8 InternalEeprom_readBlock(uint16 address, uint8 *data, uint16 size);
+
+/* Inputs:
+ * 	1. The address of the first memory location.
+ * 	2. Pointer to the data to be written into the internal EEPROM.
+ * 	3. The number of bytes.
+ *
+ * Return Value: The result of write operation.
+ *
+ * Description:
+ *	Queue a block to be written by the EEPROM ready interrupt, the bytes equal to the EEPROM
+ *	bytes are skipped by the interrupt. It waits only if the queue is full, the global
+ *	interrupts must be enabled.
+ */
+uint8 InternalEeprom_writeBlock(uint16 address, const uint8 *data, uint16 size);
+
+/* Inputs: void.
+ *
+ * Return Value: TRUE if the queue is empty and no write cycle is running, FALSE otherwise.
+ *
+ * Description:
+ *	Check the internal EEPROM write queue.
+ */
+boolean InternalEeprom_isReady(void);
+
+#endif /* INTERNAL_EEPROM_H_ */
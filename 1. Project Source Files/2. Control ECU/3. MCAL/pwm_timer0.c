@@ -10,12 +10,122 @@
 /****************************************************************************
  * 								  Includes								    *
  ****************************************************************************/
+#include <avr/interrupt.h>
 #include "pwm_timer0.h"
+#include "common_macros.h"
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Global variables to hold the address of the call back function in the application */
+static void (*volatile g_callBackPtr)(void) = NULL_PTR ;
+
+/****************************************************************************
+ * 						 Interrupt Service Routines							*
+ ****************************************************************************/
+ISR(TIMER0_OVF_vect)
+{
+	if(g_callBackPtr != NULL_PTR)
+	{
+		g_callBackPtr();
+	}
+}
 
 /****************************************************************************
  * 							Functions Definitions						    *
  ****************************************************************************/
 
+/* Inputs:
+ * 	1. Pointer to user defined data type : PWM_Timer0_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ * 	The function responsible for trigger the Timer0 with the PWM Mode, it is called once.
+ * 	Setup the fast or phase correct PWM mode with Non-Inverting output.
+ * 	Setup the required prescaler which selects the PWM frequency.
+ * 	Setup the initial compare value.
+ *	Setup the direction for OC0 as output pin through the GPIO driver.
+ */
+void PWM_Timer0_init(const PWM_Timer0_ConfigType *Config_Ptr)
+{
+	/* Stop the clock while the timer is being configured */
+	TCCR0 = 0 ;
+
+	TCNT0 = 0 ;
+
+	OCR0 = Config_Ptr->initial_duty ;
+
+	GPIO_setupPinDirection(PORTB_ID, PIN3_ID, PIN_OUTPUT);
+
+	switch(Config_Ptr->mode)
+	{
+	case PWM_Timer0_Fast_Mode :
+		/* Clear OC0 on compare match, set OC0 at BOTTOM (non-inverting mode) */
+		TCCR0 = (1<<WGM00) | (1<<WGM01) | (1<<COM01) ;
+		break;
+	case PWM_Timer0_Phase_Correct_Mode :
+		/* Clear OC0 on compare match when up-counting, set OC0 when down-counting */
+		TCCR0 = (1<<WGM00) | (1<<COM01) ;
+		break;
+	}
+
+	/* Start the clock with the required prescaler */
+	TCCR0 = ( TCCR0 & 0xF8 ) | ( Config_Ptr->prescaler & 0x07 ) ;
+}
+
+/* Inputs:
+ * 	1. duty_0_255: The required duty cycle of the generated PWM signal, 0 → 255 is 0% → 100%.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ * 	Update the duty cycle by writing OCR0 only. OCR0 is double buffered in the PWM modes,
+ * 	so the new duty starts with the next PWM period without any glitch.
+ */
+void PWM_Timer0_setDuty(uint8 duty_0_255)
+{
+	OCR0 = duty_0_255 ;
+}
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address, it is called on every Timer0 overflow
+ *	(once per PWM period). The overflow interrupt is enabled with a valid function and
+ *	disabled with NULL_PTR.
+ */
+void PWM_Timer0_setCallBack(void(*a_ptr)(void))
+{
+	uint8 sreg ;
+
+	/* Save the address of the Call back function in a global variable */
+	g_callBackPtr = a_ptr ;
+
+	if(a_ptr != NULL_PTR)
+	{
+		/* Clear an old overflow flag only, writing one clears the flag */
+		TIFR = (1<<TOV0) ;
+		/* TIMSK is shared by all the timers, it is changed from their interrupts too */
+		sreg = SREG ;
+		cli();
+		SET_BIT(TIMSK,TOIE0);
+		SREG = sreg ;
+	}
+	else
+	{
+		sreg = SREG ;
+		cli();
+		CLEAR_BIT(TIMSK,TOIE0);
+		SREG = sreg ;
+	}
+}
+
+#if(PWM_TIMER0_FLOAT_API == TRUE)
 /* Inputs:
  * 	1. duty_cycle: The required duty cycle percentage of the generated PWM signal.
  *
@@ -27,15 +137,14 @@
  * 	Setup the prescaler with F_CPU/8.
  * 	Setup the compare value based on the required input duty cycle.
  *	Setup the direction for OC0 as output pin through the GPIO driver.
- *	The generated PWM signal frequency will be 500Hz to control the DC Motor speed.
+ *	The generated PWM signal frequency will be 3.9KHz to control the DC Motor speed.
  */
 void PWM_Timer0_Start(float duty_cycle)
 {
-	GPIO_setupPinDirection(PORTB_ID, PIN3_ID, PIN_OUTPUT);
-
-	TCCR0 |= (1<<WGM00) | (1<<WGM01) | (1<<COM01) | (1<<CS01) ;
-
-	TCNT0 = 0 ;
-
-	OCR0 = ( duty_cycle * 255 ) ;
+	PWM_Timer0_ConfigType PWM_Timer0_ConfigStruct ;
+	PWM_Timer0_ConfigStruct.mode = PWM_Timer0_Fast_Mode ;
+	PWM_Timer0_ConfigStruct.prescaler = PWM_Timer0_F_CPU_8 ;
+	PWM_Timer0_ConfigStruct.initial_duty = ( duty_cycle * 255 ) ;
+	PWM_Timer0_init(&PWM_Timer0_ConfigStruct);
 }
+#endif
@@ -17,10 +17,112 @@
 #include "std_types.h"
 #include "gpio.h"
 
+/****************************************************************************
+ * 								 Definitions								*
+ ****************************************************************************/
+
+/*
+ * Set to TRUE to build the float PWM_Timer0_Start() API,
+ * it pulls the AVR soft-float library into the image.
+ */
+#define PWM_TIMER0_FLOAT_API                 FALSE
+
+/*
+ * Scale a duty cycle in percent (0 → 100) or permille (0 → 1000) to the OCR0 range (0 → 255)
+ * with 16-bit integer math only (255/100 = 51/20 and 255/1000 = 51/200), rounded to nearest.
+ * They are folded at compile time when the argument is a constant. The argument is not limited,
+ * a value above the range wraps to a low duty.
+ */
+#define PWM_TIMER0_DUTY_FROM_PERCENT(percent)      ((uint8)((((uint16)(percent) * 51U) + 10U) / 20U))
+#define PWM_TIMER0_DUTY_FROM_PERMILLE(permille)    ((uint8)((((uint16)(permille) * 51U) + 100U) / 200U))
+
+#define PWM_TIMER0_MAX_DUTY                  255
+
+/*
+ * PWM frequency for the required mode and prescaler division factor (1, 8, 64, 256 or 1024),
+ * e.g. fast PWM with F_CPU/8 at 8MHz is 3.9KHz and phase correct PWM is 1.96KHz.
+ */
+#define PWM_TIMER0_FAST_FREQUENCY(prescaler)           (F_CPU / ((prescaler) * 256UL))
+#define PWM_TIMER0_PHASE_CORRECT_FREQUENCY(prescaler)  (F_CPU / ((prescaler) * 510UL))
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef enum
+{
+	PWM_Timer0_F_CPU_1 = 0x01,
+
+	PWM_Timer0_F_CPU_8,
+
+	PWM_Timer0_F_CPU_64,
+
+	PWM_Timer0_F_CPU_256,
+
+	PWM_Timer0_F_CPU_1024
+
+}PWM_Timer0_Prescaler;
+
+typedef enum
+{
+	PWM_Timer0_Fast_Mode,
+
+	PWM_Timer0_Phase_Correct_Mode
+
+}PWM_Timer0_Mode;
+
+typedef struct
+{
+	PWM_Timer0_Mode mode ;
+
+	PWM_Timer0_Prescaler prescaler ;
+
+	uint8 initial_duty ;
+
+}PWM_Timer0_ConfigType;
+
 /****************************************************************************
  * 							Functions Prototypes						    *
  ****************************************************************************/
 
+/* Inputs:
+ * 	1. Pointer to user defined data type : PWM_Timer0_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ * 	The function responsible for trigger the Timer0 with the PWM Mode, it is called once.
+ * 	Setup the fast or phase correct PWM mode with Non-Inverting output.
+ * 	Setup the required prescaler which selects the PWM frequency.
+ * 	Setup the initial compare value.
+ *	Setup the direction for OC0 as output pin through the GPIO driver.
+ */
+void PWM_Timer0_init(const PWM_Timer0_ConfigType *Config_Ptr);
+
+/* Inputs:
+ * 	1. duty_0_255: The required duty cycle of the generated PWM signal, 0 → 255 is 0% → 100%.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ * 	Update the duty cycle by writing OCR0 only. OCR0 is double buffered in the PWM modes,
+ * 	so the new duty starts with the next PWM period without any glitch.
+ */
+void PWM_Timer0_setDuty(uint8 duty_0_255);
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address, it is called on every Timer0 overflow
+ *	(once per PWM period). The overflow interrupt is enabled with a valid function and
+ *	disabled with NULL_PTR.
+ */
+void PWM_Timer0_setCallBack(void(*a_ptr)(void));
+
+#if(PWM_TIMER0_FLOAT_API == TRUE)
 /* Inputs:
  * 	1. duty_cycle: The required duty cycle percentage of the generated PWM signal.
  *
@@ -32,9 +134,10 @@
  * 	Setup the prescaler with F_CPU/8.
  * 	Setup the compare value based on the required input duty cycle.
  *	Setup the direction for OC0 as output pin through the GPIO driver.
- *	The generated PWM signal frequency will be 500Hz to control the DC Motor speed.
+ *	The generated PWM signal frequency will be 3.9KHz to control the DC Motor speed.
  */
 void PWM_Timer0_Start(float duty_cycle);
+#endif
 
 
 #endif /* PWM_TIMER0_H_ */
@@ -0,0 +1,147 @@
+/*
+ ============================================================================
+ Name        : timer2.c
+ Author      : Ahmed Shawky
+ Description : Source File for Timer2 Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "timer2.h"
+#include "common_macros.h"
+
+/****************************************************************************
+ * 						   Static Global Variables							*
+ ****************************************************************************/
+
+/* Global variables to hold the address of the call back function in the application */
+static void (*volatile g_callBackPtr)(void) = NULL_PTR ;
+
+
+/****************************************************************************
+ * 						 Interrupt Service Routines							*
+ ****************************************************************************/
+ISR(TIMER2_OVF_vect)
+{
+	if(g_callBackPtr != NULL_PTR)
+	{
+		g_callBackPtr();
+	}
+}
+
+ISR(TIMER2_COMP_vect)
+{
+	if(g_callBackPtr != NULL_PTR)
+	{
+		g_callBackPtr();
+	}
+}
+
+/****************************************************************************
+ * 							Functions Definitions						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : Timer2_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start Timer2 in normal (overflow) or compare (CTC) mode with the required
+ *	prescaler, the interrupt of the selected mode is enabled and calls the
+ *	Call Back function on every overflow/compare match.
+ */
+void Timer2_init(const Timer2_ConfigType *Config_Ptr)
+{
+	uint8 sreg ;
+
+	/* Stop the clock while the timer is being configured */
+	TCCR2 = 0 ;
+
+	switch(Config_Ptr->mode)
+	{
+	case Timer2_Normal_Mode :
+
+		/* Normal port operation OC2 disconnected, non-PWM mode */
+		TCCR2 = (1<<FOC2) ;
+
+		/* TIMSK is shared by all the timers, it is changed from their interrupts too */
+		sreg = SREG ;
+		cli();
+		CLEAR_BIT(TIMSK,OCIE2);
+		SET_BIT(TIMSK,TOIE2);
+		SREG = sreg ;
+		break;
+	case Timer2_Compare_Mode :
+
+		/* Normal port operation OC2 disconnected, clear timer on compare match */
+		TCCR2 = (1<<FOC2) | (1<<WGM21) ;
+
+		OCR2 = Config_Ptr->compare_value ;
+
+		sreg = SREG ;
+		cli();
+		CLEAR_BIT(TIMSK,TOIE2);
+		SET_BIT(TIMSK,OCIE2);
+		SREG = sreg ;
+		break;
+	}
+
+	TCNT2 = Config_Ptr->initial_value ;
+
+	/* Start the clock with the required prescaler */
+	TCCR2 = ( TCCR2 & 0xF8 ) | ( Config_Ptr->prescaler & 0x07 ) ;
+}
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop Timer2 and disable its interrupts only, the other timers are not affected.
+ */
+void Timer2_deInit(void)
+{
+	uint8 sreg ;
+
+	TCCR2 = 0 ;
+	sreg = SREG ;
+	cli();
+	TIMSK &= ~((1<<TOIE2) | (1<<OCIE2)) ;
+	SREG = sreg ;
+	TCNT2 = 0 ;
+	OCR2 = 0 ;
+}
+
+/* Inputs:
+ * 	1. compare_value: The new compare value.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Change the CTC period while the timer is running, it is used from the Call Back
+ *	function to start the next period with the new value.
+ */
+void Timer2_setCompareValue(uint8 compare_value)
+{
+	OCR2 = compare_value ;
+}
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address.
+ */
+void Timer2_setCallBack(void(*a_ptr)(void))
+{
+	/* Save the address of the Call back function in a global variable */
+	g_callBackPtr = a_ptr ;
+}
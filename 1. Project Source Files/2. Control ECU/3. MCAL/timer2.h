@@ -0,0 +1,108 @@
+/*
+ ============================================================================
+ Name        : timer2.h
+ Author      : Ahmed Shawky
+ Description : Header File for Timer2 Driver
+ Date        : 19/10/2026
+ ============================================================================
+ */
+
+#ifndef TIMER2_H_
+#define TIMER2_H_
+
+/****************************************************************************
+ * 								  Includes								    *
+ ****************************************************************************/
+#include "std_types.h"
+
+/****************************************************************************
+ * 					          Types Declaration						        *
+ ****************************************************************************/
+
+typedef enum
+{
+	Timer2_F_CPU_1 = 0x01,
+
+	Timer2_F_CPU_8,
+
+	Timer2_F_CPU_32,
+
+	Timer2_F_CPU_64,
+
+	Timer2_F_CPU_128,
+
+	Timer2_F_CPU_256,
+
+	Timer2_F_CPU_1024
+
+}Timer2_Prescaler;
+
+typedef enum
+{
+	Timer2_Normal_Mode,
+
+	Timer2_Compare_Mode
+
+}Timer2_Mode;
+
+typedef struct
+{
+	uint8 initial_value ;
+
+	uint8 compare_value ;
+
+	Timer2_Prescaler prescaler ;
+
+	Timer2_Mode mode ;
+
+}Timer2_ConfigType;
+
+
+/****************************************************************************
+ * 							Functions Prototypes						    *
+ ****************************************************************************/
+
+/* Inputs:
+ * 	1. Pointer to user defined data type : Timer2_ConfigType.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Start Timer2 in normal (overflow) or compare (CTC) mode with the required
+ *	prescaler, the interrupt of the selected mode is enabled and calls the
+ *	Call Back function on every overflow/compare match.
+ */
+void Timer2_init(const Timer2_ConfigType *Config_Ptr);
+
+/* Inputs: void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Stop Timer2 and disable its interrupts only, the other timers are not affected.
+ */
+void Timer2_deInit(void);
+
+/* Inputs:
+ * 	1. compare_value: The new compare value.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Change the CTC period while the timer is running, it is used from the Call Back
+ *	function to start the next period with the new value.
+ */
+void Timer2_setCompareValue(uint8 compare_value);
+
+/* Inputs:
+ * 	1. Pointer to a Call Back function has a parameter void and return void.
+ *
+ * Return Value: void.
+ *
+ * Description:
+ *	Function to set the Call Back function address.
+ */
+void Timer2_setCallBack(void(*a_ptr)(void));
+
+
+#endif /* TIMER2_H_ */